@@ -0,0 +1,179 @@
+/**
+ * @file gen_corpus.cpp
+ * @brief Generator of synthetic C sources for benchmarking the plugin
+ * @version 0.1
+ *
+ * Usage: gen_corpus SHAPE SIZE [HOOK]
+ *
+ * The C source of a function with a CFG of the given shape is written on the
+ * standard output. SHAPE is one of:
+ * <ul>
+ * <li>diamonds: a chain of SIZE if-then-else diamonds (2^SIZE paths)</li>
+ * <li>loops: SIZE nested loops, with a branch in each loop body</li>
+ * <li>switch: a switch with SIZE cases followed by a test</li>
+ * <li>calls: a chain of SIZE blocks, each with calls and stores through
+ * pointers, separated by branches</li>
+ * <li>mixed: all the above, each with size SIZE / 2</li>
+ * </ul>
+ * HOOK tells where a LSM hook is placed: "none" (the default), "branch" (in
+ * the first branch, so that half the paths go through it) or "entry" (at the
+ * entry of the function, so that the flow block is dominated by it).
+ * The flow marker is always at the end of the function.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+	/**
+	 * @brief Where the LSM hook is placed
+	 */
+	enum class Hook { NONE, BRANCH, ENTRY };
+
+	/**
+	 * @brief Outputs a chain of diamonds
+	 * @param out the output stream
+	 * @param size the number of diamonds
+	 * @param hook where the LSM hook is placed
+	 */
+	void diamonds(std::ostream& out, int size, Hook hook)
+	{
+		for (int i = 0 ; i < size ; i++) {
+			// the guards on the parameter are correlated, the
+			// ones on x are not
+			const char* var = (i % 2) ? "x" : "a";
+			out << "\tif (" << var << " > " << i << ") {\n"
+			    << "\t\tx = x + b;\n";
+			if (i == 0 && hook == Hook::BRANCH)
+				out << "\t\tsecurity_check(x);\n";
+			out << "\t} else {\n"
+			    << "\t\tx = x - " << i + 1 << ";\n"
+			    << "\t}\n";
+		}
+	}
+
+	/**
+	 * @brief Outputs nested loops
+	 * @param out the output stream
+	 * @param size the depth of the loop nest
+	 * @param hook where the LSM hook is placed
+	 */
+	void loops(std::ostream& out, int size, Hook hook)
+	{
+		for (int i = 0 ; i < size ; i++) {
+			std::string indent(i + 1, '\t');
+			out << indent << "for (int i" << i << " = 0 ; i" << i
+			    << " < a ; i" << i << "++) {\n"
+			    << indent << "\tif (i" << i << " == b)\n"
+			    << indent << "\t\tx += " << i + 1 << ";\n";
+			if (i == 0 && hook == Hook::BRANCH)
+				out << indent << "\telse\n"
+				    << indent << "\t\tsecurity_check(x);\n";
+		}
+		for (int i = size - 1 ; i >= 0 ; i--)
+			out << std::string(i + 1, '\t') << "}\n";
+	}
+
+	/**
+	 * @brief Outputs a switch followed by a test on the selected case
+	 * @param out the output stream
+	 * @param size the number of cases
+	 * @param hook where the LSM hook is placed
+	 */
+	void fan(std::ostream& out, int size, Hook hook)
+	{
+		out << "\tswitch (a) {\n";
+		for (int i = 0 ; i < size ; i++) {
+			out << "\t\tcase " << i << ":\n"
+			    << "\t\t\tx = " << i * 3 << " + b;\n";
+			if (i == 0 && hook == Hook::BRANCH)
+				out << "\t\t\tsecurity_check(x);\n";
+			out << "\t\t\tbreak;\n";
+		}
+		out << "\t\tdefault:\n"
+		    << "\t\t\tx = -1;\n"
+		    << "\t}\n"
+		    << "\tif (x == " << size / 2 * 3 << ")\n"
+		    << "\t\tx = 0;\n";
+	}
+
+	/**
+	 * @brief Outputs a chain of blocks full of calls and stores through
+	 * pointers
+	 * @param out the output stream
+	 * @param size the number of blocks
+	 * @param hook where the LSM hook is placed
+	 */
+	void calls(std::ostream& out, int size, Hook hook)
+	{
+		out << "\tint v = a;\n"
+		    << "\tint* p = (b > 0) ? &v : &x;\n";
+		for (int i = 0 ; i < size ; i++) {
+			out << "\tx = opaque(x + " << i << ");\n"
+			    << "\t*p = x - v;\n"
+			    << "\tif (v > " << i << ") {\n"
+			    << "\t\tv = opaque(v);\n";
+			if (i == 0 && hook == Hook::BRANCH)
+				out << "\t\tsecurity_check(v);\n";
+			out << "\t}\n";
+		}
+		out << "\tx += v;\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " SHAPE SIZE [HOOK]" << std::endl;
+		return 1;
+	}
+	std::string shape = argv[1];
+	int size = std::atoi(argv[2]);
+	std::string hookName = argc > 3 ? argv[3] : "none";
+	Hook hook;
+	if (hookName == "none")
+		hook = Hook::NONE;
+	else if (hookName == "branch")
+		hook = Hook::BRANCH;
+	else if (hookName == "entry")
+		hook = Hook::ENTRY;
+	else {
+		std::cerr << "Unknown hook placement: " << hookName << std::endl;
+		return 1;
+	}
+
+	std::ostream& out = std::cout;
+	out << "/* generated by gen_corpus " << shape << " " << size
+	    << " " << hookName << " */\n"
+	    << "extern void kayrebt_FlowNodeMarker(void);\n"
+	    << "extern int security_check(int);\n"
+	    << "extern int opaque(int);\n\n"
+	    << "int bench_" << shape << "(int a, int b)\n"
+	    << "{\n"
+	    << "\tint x = b;\n";
+	if (hook == Hook::ENTRY)
+		out << "\tsecurity_check(a);\n";
+
+	if (shape == "diamonds") {
+		diamonds(out, size, hook);
+	} else if (shape == "loops") {
+		loops(out, size, hook);
+	} else if (shape == "switch") {
+		fan(out, size, hook);
+	} else if (shape == "calls") {
+		calls(out, size, hook);
+	} else if (shape == "mixed") {
+		diamonds(out, size / 2, hook);
+		loops(out, size / 2, Hook::NONE);
+		fan(out, size / 2, Hook::NONE);
+		calls(out, size / 2, Hook::NONE);
+	} else {
+		std::cerr << "Unknown shape: " << shape << std::endl;
+		return 1;
+	}
+
+	out << "\tkayrebt_FlowNodeMarker();\n"
+	    << "\treturn x;\n"
+	    << "}\n";
+	return 0;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file replay_queries.cpp
+ * @brief Replays a log of solver queries captured by the plugin against an
+ * SMT-LIB2 solver and reports the latency distribution
+ * @version 0.1
+ *
+ * Usage: replay_queries LOG SOLVER [ARGS...]
+ *
+ * LOG is a query log written by the plugin with
+ * -fplugin-arg-kayrebt_pathexaminer2-capture=FILE, i.e. one of the FILE.PID
+ * files, one per compiler process. SOLVER is run with ARGS as
+ * an incremental SMT-LIB2 solver reading its standard input, e.g.
+ * "yices-smt2 --incremental" or "z3 -in", so the solver configuration to
+ * evaluate is given by ARGS. The log is fed to the solver command by command
+ * and each check is timed from the moment it is sent to the moment the
+ * answer is read. The replay turns :print-success on and waits for the reply
+ * to each command, so that an error is charged to the command that caused
+ * it and the time of a check does not include the commands before it.
+ *
+ * The latency distribution of the replay is printed along with the one
+ * recorded in the log, and the checks whose verdict differs from the
+ * recorded one are counted (an "unknown" verdict differs from nothing).
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+	/**
+	 * @brief A solver running in a child process
+	 */
+	struct Solver {
+		/**
+		 * @brief The process identifier of the solver
+		 */
+		pid_t pid;
+		/**
+		 * @brief The standard input of the solver
+		 */
+		FILE* in;
+		/**
+		 * @brief The standard output of the solver
+		 */
+		FILE* out;
+	};
+
+	/**
+	 * @brief Starts a solver
+	 * @param argv the command line of the solver, terminated by nullptr
+	 * @param solver the solver to fill
+	 * @return true if, and only if, the solver could be started
+	 */
+	bool start(char* argv[], Solver& solver)
+	{
+		int toSolver[2];
+		int fromSolver[2];
+		if (pipe(toSolver) < 0 || pipe(fromSolver) < 0)
+			return false;
+
+		solver.pid = fork();
+		if (solver.pid < 0)
+			return false;
+		if (solver.pid == 0) {
+			dup2(toSolver[0], STDIN_FILENO);
+			dup2(fromSolver[1], STDOUT_FILENO);
+			close(toSolver[0]);
+			close(toSolver[1]);
+			close(fromSolver[0]);
+			close(fromSolver[1]);
+			execvp(argv[0], argv);
+			std::perror(argv[0]);
+			_exit(127);
+		}
+		close(toSolver[0]);
+		close(fromSolver[1]);
+		solver.in = fdopen(toSolver[1], "w");
+		solver.out = fdopen(fromSolver[0], "r");
+		return solver.in && solver.out;
+	}
+
+	/**
+	 * @brief Reads the reply of the solver to a command
+	 * @param solver the solver
+	 * @param answer the reply read, without the trailing newline
+	 * @return false if the solver has exited
+	 */
+	bool readAnswer(Solver& solver, std::string& answer)
+	{
+		answer.clear();
+		int c;
+		while ((c = std::fgetc(solver.out)) != EOF && c != '\n')
+			answer += static_cast<char>(c);
+		return c != EOF || !answer.empty();
+	}
+
+	/**
+	 * @brief Prints a latency distribution
+	 * @param name the name of the distribution
+	 * @param latencies the latencies, in microseconds, sorted in place
+	 */
+	void report(const char* name, std::vector<long long>& latencies)
+	{
+		if (latencies.empty()) {
+			std::cout << name << ": no check" << std::endl;
+			return;
+		}
+		std::sort(latencies.begin(), latencies.end());
+		long long total = 0;
+		for (long long l : latencies)
+			total += l;
+		auto percentile = [&latencies](double p) {
+			return latencies[std::min(latencies.size() - 1,
+						  static_cast<size_t>(p * latencies.size()))];
+		};
+		std::cout << name << " (us): "
+			  << "min " << latencies.front()
+			  << ", p50 " << percentile(0.5)
+			  << ", p90 " << percentile(0.9)
+			  << ", p99 " << percentile(0.99)
+			  << ", max " << latencies.back()
+			  << ", mean " << total / static_cast<long long>(latencies.size())
+			  << ", total " << total << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " LOG SOLVER [ARGS...]" << std::endl;
+		return 1;
+	}
+	std::ifstream log(argv[1]);
+	if (!log) {
+		std::cerr << "Cannot open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+	Solver solver;
+	if (!start(argv + 2, solver)) {
+		std::cerr << "Cannot start " << argv[2] << std::endl;
+		return 1;
+	}
+
+	std::vector<long long> replayed;
+	std::vector<long long> recorded;
+	unsigned long mismatches = 0;
+	unsigned long errors = 0;
+	// the verdict of the last check replayed, compared with the
+	// recorded one in the comment following the check
+	std::string answer;
+	// every command gets a reply, the log turns :print-success off
+	// since the plugin does not read the replies
+	std::string line = "(set-option :print-success true)";
+	bool exited = false;
+	auto send = [&](const std::string& command) {
+		std::fputs(command.c_str(), solver.in);
+		std::fputc('\n', solver.in);
+		std::fflush(solver.in);
+		if (!readAnswer(solver, answer)) {
+			std::cerr << "The solver exited prematurely" << std::endl;
+			exited = true;
+		}
+	};
+	auto checkSuccess = [&](const std::string& command) {
+		if (answer == "success")
+			return;
+		if (errors++ == 0)
+			std::cerr << "First solver error: " << answer
+				  << "\n\tin reply to: " << command << std::endl;
+	};
+	send(line);
+	if (!exited)
+		checkSuccess(line);
+	while (!exited && std::getline(log, line)) {
+		const char result[] = "; result: ";
+		if (line.compare(0, sizeof(result) - 1, result) == 0) {
+			std::string verdict = line.substr(sizeof(result) - 1);
+			verdict = verdict.substr(0, verdict.find(' '));
+			std::string::size_type time = line.find("time_us: ");
+			if (time != line.npos)
+				recorded.push_back(std::atoll(line.c_str() + time + 9));
+			if (verdict != "unknown" && answer != "unknown" && verdict != answer)
+				mismatches++;
+			continue;
+		}
+		if (line.empty() || line[0] == ';' ||
+		    line == "(set-option :print-success false)")
+			continue;
+
+		if (line != "(check-sat)") {
+			send(line);
+			if (!exited)
+				checkSuccess(line);
+			continue;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		send(line);
+		if (exited)
+			break;
+		replayed.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start).count());
+		if (answer.compare(0, 6, "(error") == 0) {
+			if (errors++ == 0)
+				std::cerr << "First solver error: " << answer
+					  << "\n\tin reply to: " << line << std::endl;
+		}
+	}
+	std::fclose(solver.in);
+	std::fclose(solver.out);
+	int status;
+	waitpid(solver.pid, &status, 0);
+
+	std::cout << replayed.size() << " checks replayed, "
+		  << mismatches << " verdict mismatches, "
+		  << errors << " solver errors" << std::endl;
+	report("replayed", replayed);
+	report("recorded", recorded);
+	return (mismatches > 0 || errors > 0) ? 2 : 0;
+}
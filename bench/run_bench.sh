@@ -0,0 +1,66 @@
+#!/bin/sh
+# Runs the plugin on the synthetic corpus and records, for each case, the
+# wall time of the compilation, the solver calls and the peak RSS.
+#
+# Usage: run_bench.sh CC PLUGIN GEN_CORPUS OUTPUT
+#
+# CC is a gcc 4.8 able to load PLUGIN, the plugin shared object, GEN_CORPUS
+# is the corpus generator and OUTPUT the baseline file to write. The baseline
+# is a tab-separated file with a header line, one line per case.
+#
+# The cases are given as SHAPE:SIZE:HOOK in the CASES environment variable,
+# a default corpus is used otherwise.
+
+set -e
+
+if [ $# -ne 4 ]; then
+	echo "Usage: $0 CC PLUGIN GEN_CORPUS OUTPUT" >&2
+	exit 1
+fi
+CC=$1
+PLUGIN=$2
+GEN_CORPUS=$3
+OUTPUT=$4
+
+: ${CASES:="diamonds:8:none diamonds:12:none diamonds:12:branch diamonds:12:entry
+	loops:2:none loops:4:none loops:4:branch switch:16:none switch:64:none
+	calls:8:none calls:16:branch mixed:8:none mixed:12:none"}
+
+TIME=/usr/bin/time
+if [ ! -x $TIME ]; then
+	echo "GNU time is required to measure the peak RSS" >&2
+	exit 1
+fi
+if ! command -v sqlite3 >/dev/null; then
+	echo "sqlite3 is required to read the solver statistics" >&2
+	exit 1
+fi
+
+NAME=`basename $PLUGIN .so`
+WORKDIR=`mktemp -d`
+trap 'rm -rf $WORKDIR' EXIT
+
+printf 'case\twall_s\tmax_rss_kb\tsolver_calls\tsolver_calls_avoided\tpaths_found\tpaths_rejected\tverdicts\n' > $OUTPUT
+for c in $CASES; do
+	shape=`echo $c | cut -d: -f1`
+	size=`echo $c | cut -d: -f2`
+	hook=`echo $c | cut -d: -f3`
+	src=$WORKDIR/$shape-$size-$hook.c
+	db=$WORKDIR/$shape-$size-$hook.db
+	$GEN_CORPUS $shape $size $hook > $src
+
+	if ! $TIME -f '%e %M' -o $WORKDIR/time $CC -std=gnu99 -O2 -c \
+		-fplugin=$PLUGIN -fplugin-arg-$NAME-db=$db \
+		$src -o /dev/null 2> $WORKDIR/log; then
+		echo "$c: compilation failed, see below" >&2
+		tail -n 20 $WORKDIR/log >&2
+		printf '%s\tfailed\n' $c >> $OUTPUT
+		continue
+	fi
+
+	read wall rss < $WORKDIR/time
+	stats=`sqlite3 -separator '	' $db \
+		"SELECT IFNULL(SUM(solver_calls), 0), IFNULL(SUM(solver_calls_avoided), 0), IFNULL(SUM(paths_found), 0), IFNULL(SUM(paths_rejected), 0), IFNULL(GROUP_CONCAT(verdict), '-') FROM flow_blocks"`
+	printf '%s\t%s\t%s\t%s\n' $c $wall $rss "$stats" >> $OUTPUT
+	echo "$c: ${wall}s, ${rss}kB" >&2
+done
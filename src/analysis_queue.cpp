@@ -0,0 +1,62 @@
+/**
+ * @file analysis_queue.cpp
+ * @brief Implementation of the AnalysisQueue class
+ * @version 0.1
+ */
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "analysis_queue.h"
+
+AnalysisQueue::AnalysisQueue(unsigned int workers)
+{
+	workers = std::max(workers, 1U);
+	for (unsigned int i = 0 ; i < workers ; i++)
+		_workers.emplace_back(&AnalysisQueue::work, this);
+}
+
+AnalysisQueue::~AnalysisQueue()
+{
+	join();
+}
+
+void AnalysisQueue::submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_jobs.push_back(std::move(job));
+	}
+	_ready.notify_one();
+}
+
+void AnalysisQueue::join()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_closed = true;
+	}
+	_ready.notify_all();
+	for (std::thread& t : _workers)
+		if (t.joinable())
+			t.join();
+	_workers.clear();
+}
+
+void AnalysisQueue::work()
+{
+	for (;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_ready.wait(lock, [this]() { return _closed || !_jobs.empty(); });
+			if (_jobs.empty())
+				return;
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+		job();
+	}
+}
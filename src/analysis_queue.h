@@ -0,0 +1,78 @@
+/**
+ * @file analysis_queue.h
+ * @brief Definition of the AnalysisQueue class
+ * @version 0.1
+ */
+#ifndef ANALYSIS_QUEUE_H
+#define ANALYSIS_QUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A pool of worker threads running the path walks in the background
+ *
+ * The jobs are run in the order in which they are submitted, by the first
+ * worker available. A job must not call the GCC API: everything it needs
+ * from the compiler has to be snapshotted before it is submitted.
+ */
+class AnalysisQueue
+{
+	private:
+		/**
+		 * @brief The worker threads
+		 */
+		std::vector<std::thread> _workers;
+		/**
+		 * @brief The jobs not started yet
+		 */
+		std::deque<std::function<void()>> _jobs;
+		/**
+		 * @brief Protects \a _jobs and \a _closed
+		 */
+		std::mutex _mutex;
+		/**
+		 * @brief Signaled when a job is submitted or the queue is
+		 * closed
+		 */
+		std::condition_variable _ready;
+		/**
+		 * @brief Whether join() has been called
+		 */
+		bool _closed = false;
+
+		/**
+		 * @brief Runs the jobs until the queue is closed and empty
+		 */
+		void work();
+
+	public:
+		/**
+		 * @brief Starts the worker threads
+		 * @param workers the number of worker threads, at least 1
+		 */
+		explicit AnalysisQueue(unsigned int workers);
+		/**
+		 * @brief Waits for the outstanding jobs, if join() has not
+		 * been called yet
+		 */
+		~AnalysisQueue();
+		AnalysisQueue(const AnalysisQueue&) = delete;
+		AnalysisQueue& operator=(const AnalysisQueue&) = delete;
+		/**
+		 * @brief Queues a job
+		 * @param job the job, which must not throw
+		 */
+		void submit(std::function<void()> job);
+		/**
+		 * @brief Waits for all the jobs submitted to be complete and
+		 * stops the worker threads
+		 */
+		void join();
+};
+
+#endif /* ifndef ANALYSIS_QUEUE_H */
@@ -0,0 +1,172 @@
+/**
+ * @file analysis_settings.h
+ * @brief Definition of the AnalysisSettings structure
+ * @version 0.1
+ */
+#ifndef ANALYSIS_SETTINGS_H
+#define ANALYSIS_SETTINGS_H
+
+#include <string>
+
+/**
+ * @brief The parameters of the analysis of one function
+ */
+struct AnalysisSettings {
+	/**
+	 * @brief The ways the paths to a flow block can be searched
+	 */
+	enum class SearchMode {
+		EXHAUSTIVE, //! Enumerate all the feasible paths
+		FIRST_WITNESS, //! Stop as soon as one feasible path is found
+		SAMPLING //! Check paths drawn uniformly at random and estimate the fraction of feasible ones
+	};
+
+	/**
+	 * @brief The orders in which the successors of a basic block can be
+	 * explored
+	 */
+	enum class SuccessorOrder {
+		CFG, //! The order of the edges in the CFG
+		PROBABILITY //! The most likely edges first, according to GCC's profile estimates
+	};
+
+	/**
+	 * @brief The directions in which the paths to a flow block can be
+	 * walked
+	 */
+	enum class Direction {
+		FORWARD, //! From the root of the function to the flow block
+		BACKWARD, //! From the flow block to the root, collecting the preconditions
+		AUTO //! The cheapest of the two, as estimated for each flow block
+	};
+
+	/**
+	 * @brief The ways the feasible paths found can be reported
+	 */
+	enum class PathOutput {
+		LIST, //! Print every feasible path in full
+		DAG, //! Print the union of the feasible paths, as a DAG
+		COUNTED_DAG //! Same as DAG, with the number of feasible paths through each node and edge
+	};
+
+	/**
+	 * @brief The maximum number of satisfiability checks per flow block,
+	 * 0 meaning no limit
+	 */
+	unsigned long budget = 0;
+	/**
+	 * @brief The search mode
+	 */
+	SearchMode mode = SearchMode::EXHAUSTIVE;
+	/**
+	 * @brief The order in which the successors of a basic block are
+	 * explored
+	 */
+	SuccessorOrder order = SuccessorOrder::CFG;
+	/**
+	 * @brief The direction in which the paths are walked, in exhaustive
+	 * and first-witness modes
+	 */
+	Direction direction = Direction::FORWARD;
+	/**
+	 * @brief How the feasible paths found are reported
+	 */
+	PathOutput output = PathOutput::LIST;
+	/**
+	 * @brief The maximum number of feasible paths to keep in the result
+	 * of each flow block
+	 */
+	unsigned int witnesses = 0;
+	/**
+	 * @brief The maximum number of pending states kept in memory during
+	 * the walk of the paths, the others being spilled to a temporary
+	 * file, 0 meaning no limit
+	 */
+	unsigned long frontier = 0;
+	/**
+	 * @brief The number of paths drawn per flow block in sampling mode
+	 */
+	unsigned long samples = 1000;
+	/**
+	 * @brief The seed of the random generator in sampling mode, the
+	 * paths drawn are the same from one run to another with the same seed
+	 */
+	unsigned long seed = 0;
+
+	/**
+	 * @brief Parses the name of a search mode
+	 * @param name the name, as it can be given in the configuration file
+	 * or on the command line
+	 * @param mode the mode to set
+	 * @return true if, and only if, \a name is a valid mode name, in
+	 * which case \a mode is set accordingly
+	 */
+	static bool parseSearchMode(const std::string& name, SearchMode& mode) {
+		if (name == "exhaustive")
+			mode = SearchMode::EXHAUSTIVE;
+		else if (name == "first-witness")
+			mode = SearchMode::FIRST_WITNESS;
+		else if (name == "sampling")
+			mode = SearchMode::SAMPLING;
+		else
+			return false;
+		return true;
+	}
+	/**
+	 * @brief Parses the name of a successor order
+	 * @param name the name, as it can be given in the configuration file
+	 * or on the command line
+	 * @param order the order to set
+	 * @return true if, and only if, \a name is a valid order name, in
+	 * which case \a order is set accordingly
+	 */
+	static bool parseSuccessorOrder(const std::string& name, SuccessorOrder& order) {
+		if (name == "cfg")
+			order = SuccessorOrder::CFG;
+		else if (name == "probability")
+			order = SuccessorOrder::PROBABILITY;
+		else
+			return false;
+		return true;
+	}
+	/**
+	 * @brief Parses the name of a walk direction
+	 * @param name the name, as it can be given in the configuration file
+	 * or on the command line
+	 * @param direction the direction to set
+	 * @return true if, and only if, \a name is a valid direction name,
+	 * in which case \a direction is set accordingly
+	 */
+	static bool parseDirection(const std::string& name, Direction& direction) {
+		if (name == "forward")
+			direction = Direction::FORWARD;
+		else if (name == "backward")
+			direction = Direction::BACKWARD;
+		else if (name == "auto")
+			direction = Direction::AUTO;
+		else
+			return false;
+		return true;
+	}
+	/**
+	 * @brief Parses the name of a path output
+	 * @param name the name, as it can be given in the configuration file
+	 * or on the command line
+	 * @param output the output to set
+	 * @return true if, and only if, \a name is a valid output name, in
+	 * which case \a output is set accordingly
+	 */
+	static bool parsePathOutput(const std::string& name, PathOutput& output) {
+		if (name == "paths")
+			output = PathOutput::LIST;
+		else if (name == "dag")
+			output = PathOutput::DAG;
+		else if (name == "dag-counts")
+			output = PathOutput::COUNTED_DAG;
+		else
+			return false;
+		return true;
+	}
+};
+
+#endif /* ifndef ANALYSIS_SETTINGS_H */
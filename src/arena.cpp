@@ -0,0 +1,43 @@
+/**
+ * @file arena.cpp
+ * @brief Implementation of the Arena class
+ * @version 0.1
+ */
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "arena.h"
+
+constexpr std::size_t Arena::CHUNK_SIZE;
+
+Arena::~Arena()
+{
+	for (char* chunk : _chunks)
+		::operator delete(chunk);
+}
+
+void* Arena::allocate(std::size_t size, std::size_t align)
+{
+	std::size_t padding = (align - reinterpret_cast<std::uintptr_t>(_current) % align) % align;
+	if (!_current || padding + size > _left) {
+		// the large blocks get a chunk of their own, the current
+		// chunk keeps serving the small ones
+		if (size + align > CHUNK_SIZE / 4) {
+			char* chunk = static_cast<char*>(::operator new(size + align));
+			_chunks.push_back(chunk);
+			_allocated += size;
+			std::size_t p = (align - reinterpret_cast<std::uintptr_t>(chunk) % align) % align;
+			return chunk + p;
+		}
+		_current = static_cast<char*>(::operator new(CHUNK_SIZE));
+		_chunks.push_back(_current);
+		_left = CHUNK_SIZE;
+		padding = (align - reinterpret_cast<std::uintptr_t>(_current) % align) % align;
+	}
+	void* res = _current + padding;
+	_current += padding + size;
+	_left -= padding + size;
+	_allocated += size;
+	return res;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file arena.h
+ * @brief Definition of the Arena class and of the allocator drawing from it
+ * @version 0.1
+ */
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A monotonic memory arena, from which the data structures of the
+ * analysis of one function are allocated
+ *
+ * Memory is carved out of large chunks and never given back individually:
+ * all of it is released at once when the arena is destroyed, along with
+ * the function. The objects allocated from the arena must not outlive it.
+ */
+class Arena
+{
+	private:
+		/**
+		 * @brief The size of the chunks, except for the allocations
+		 * too large to fit in one
+		 */
+		static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+		/**
+		 * @brief The chunks allocated so far
+		 */
+		std::vector<char*> _chunks;
+		/**
+		 * @brief The first free byte of the current chunk
+		 */
+		char* _current = nullptr;
+		/**
+		 * @brief The number of free bytes in the current chunk
+		 */
+		std::size_t _left = 0;
+		/**
+		 * @brief The number of bytes handed out so far
+		 */
+		std::size_t _allocated = 0;
+
+	public:
+		/**
+		 * @brief Destroys an object allocated with make(), without
+		 * freeing its memory, as a deleter of std::unique_ptr
+		 */
+		struct Destroy {
+			template<typename T>
+			void operator()(T* p) const { p->~T(); }
+		};
+
+		Arena() = default;
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+		/**
+		 * @brief Releases all the memory of the arena
+		 */
+		~Arena();
+		/**
+		 * @brief Allocates a block of memory
+		 * @param size the size of the block, in bytes
+		 * @param align the alignment of the block
+		 * @return the block
+		 */
+		void* allocate(std::size_t size, std::size_t align);
+		/**
+		 * @brief Builds an object in the arena
+		 * @tparam T the type of the object
+		 * @param args the arguments of the constructor of T
+		 * @return the object, whose destructor must be called
+		 * explicitly, e.g. by Destroy
+		 */
+		template<typename T, typename... Args>
+		T* make(Args&&... args) {
+			return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+		/**
+		 * @brief Gets the amount of memory handed out
+		 * @return the number of bytes allocated from the arena
+		 */
+		std::size_t allocated() const { return _allocated; }
+};
+
+/**
+ * @brief An allocator drawing from an Arena, for the standard containers
+ *
+ * Deallocation is a no-op, the memory is released with the arena. An
+ * allocator built without an arena falls back to the global heap, so that
+ * the containers remain default-constructible.
+ * @tparam T the type of the objects allocated
+ */
+template<typename T>
+class ArenaAllocator
+{
+	private:
+		/**
+		 * @brief The arena, or nullptr for the global heap
+		 */
+		Arena* _arena;
+
+		template<typename U> friend class ArenaAllocator;
+
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef std::true_type propagate_on_container_copy_assignment;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		template<typename U>
+		struct rebind { typedef ArenaAllocator<U> other; };
+
+		/**
+		 * @brief Builds an allocator
+		 * @param arena the arena to draw from, or nullptr for the
+		 * global heap
+		 */
+		explicit ArenaAllocator(Arena* arena = nullptr) noexcept : _arena(arena) {}
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept : _arena(other._arena) {}
+
+		pointer allocate(size_type n, const void* = nullptr) {
+			if (_arena)
+				return static_cast<pointer>(_arena->allocate(n * sizeof(T), alignof(T)));
+			return static_cast<pointer>(::operator new(n * sizeof(T)));
+		}
+		void deallocate(pointer p, size_type) noexcept {
+			if (!_arena)
+				::operator delete(p);
+		}
+		template<typename U, typename... Args>
+		void construct(U* p, Args&&... args) {
+			::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+		}
+		template<typename U>
+		void destroy(U* p) { p->~U(); }
+		size_type max_size() const noexcept { return size_type(-1) / sizeof(T); }
+		pointer address(reference r) const noexcept { return std::addressof(r); }
+		const_pointer address(const_reference r) const noexcept { return std::addressof(r); }
+
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& other) const noexcept { return _arena == other._arena; }
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const noexcept { return _arena != other._arena; }
+};
+
+/**
+ * @brief A map whose nodes are allocated from an Arena
+ */
+template<typename K, typename V>
+using ArenaMap = std::map<K,V,std::less<K>,ArenaAllocator<std::pair<const K,V>>>;
+
+#endif /* ifndef ARENA_H */
@@ -0,0 +1,270 @@
+/**
+ * @file block_summary.cpp
+ * @brief Implementation of the BlockSummary class
+ * @version 0.1
+ */
+#include <cstdlib>
+#include <gcc-plugin.h>
+#include <gimple.h>
+#include <basic-block.h>
+#include <tree.h>
+#include <tree-flow.h>
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "block_summary.h"
+#include "configuration.h"
+#include "constraint.h"
+#include "debug.h"
+
+void BlockSummary::Transfer::kill(tree var)
+{
+	kills.push_back(var);
+	gens.erase(
+		std::remove_if(gens.begin(), gens.end(),
+			[&var](const std::pair<Constraint,InternedConstraint>& p) {
+				const Constraint& c = p.first;
+				return (c.lhs == var || c.rhs == var || c.rhs2 == var);
+			}),
+		gens.end()
+	);
+	ptrDestinations.erase(
+		std::remove_if(ptrDestinations.begin(), ptrDestinations.end(),
+			[&var](const std::pair<tree,tree>& p) {
+				return p.first == var;
+			}),
+		ptrDestinations.end()
+	);
+}
+
+void BlockSummary::Transfer::killMemory()
+{
+	killMem = true;
+	gens.erase(
+		std::remove_if(gens.begin(), gens.end(),
+			[](const std::pair<Constraint,InternedConstraint>& p) {
+				return p.second.mem;
+			}),
+		gens.end()
+	);
+	ptrDestinations.erase(
+		std::remove_if(ptrDestinations.begin(), ptrDestinations.end(),
+			[](const std::pair<tree,tree>& p) {
+				return !is_gimple_reg(p.first);
+			}),
+		ptrDestinations.end()
+	);
+}
+
+void BlockSummary::Transfer::gen(Constraint c)
+{
+	if (Configuration::acceptConstraint(c))
+		gens.emplace_back(c, Configuration::intern(c, Configuration::buildTerm(c)));
+}
+
+void BlockSummary::Transfer::append(const Transfer& other)
+{
+	if (other.killMem)
+		killMemory();
+	for (tree var : other.kills)
+		kill(var);
+	ptrDestinations.insert(ptrDestinations.end(),
+			       other.ptrDestinations.cbegin(), other.ptrDestinations.cend());
+	gens.insert(gens.end(), other.gens.cbegin(), other.gens.cend());
+}
+
+void BlockSummary::Transfer::apply(Configuration& k) const
+{
+	if (killMem)
+		k.resetAllVarMem();
+	for (tree var : kills)
+		k.resetVar(var);
+	for (const auto& p : ptrDestinations)
+		k.setPointerDestination(p.first, p.second);
+	for (const auto& g : gens)
+		k.addConstraint(g.second);
+}
+
+BlockSummary::BlockSummary(basic_block bb, bool withPhis)
+{
+	if (withPhis) {
+		_phis.resize(EDGE_COUNT(bb->preds));
+		for (gimple_stmt_iterator it = gsi_start_phis(bb) ;
+				!gsi_end_p(it);
+				gsi_next(&it))
+			compilePhi(gsi_stmt(it));
+	}
+
+	for (gimple_stmt_iterator it = gsi_start_bb(bb) ;
+			!gsi_end_p(it);
+			gsi_next(&it)) {
+		gimple stmt = gsi_stmt(it);
+		debug() << "Next statement : " << gimple_code_name[gimple_code(stmt)] << std::endl;
+		switch (gimple_code(stmt)) {
+			case GIMPLE_ASSIGN:
+				compileAssign(stmt);
+				break;
+			case GIMPLE_CALL:
+				compileCall(stmt);
+				break;
+			case GIMPLE_ASM:
+				current().killMemory();
+				break;
+			default:
+				; //nothing to do
+		}
+	}
+
+	// drop the trailing no-op transfer, if any
+	if (!_segments.empty() && _segments.back().pointer == NULL_TREE &&
+	    _segments.back().transfer.empty())
+		_segments.pop_back();
+	debug() << "Basic block " << bb->index << " compiled into "
+		<< _segments.size() << " segments" << std::endl;
+}
+
+BlockSummary::Transfer& BlockSummary::current()
+{
+	if (_segments.empty() || _segments.back().pointer != NULL_TREE)
+		_segments.emplace_back();
+	return _segments.back().transfer;
+}
+
+void BlockSummary::compileCall(gimple stmt)
+{
+	Transfer& t = current();
+	tree lhs = gimple_call_lhs(stmt);
+	if (lhs && lhs != NULL_TREE)
+		t.kill(lhs);
+
+	// the const and pure functions do not write to memory, this is
+	// known interprocedurally when the function is analyzed after the
+	// WPA stage of a LTO build
+	if (!(gimple_call_flags(stmt) & (ECF_CONST | ECF_PURE)))
+		t.killMemory();
+}
+
+void BlockSummary::compileAssign(gimple stmt)
+{
+	if (!gimple_assign_single_p(stmt) && !gimple_assign_cast_p(stmt)) {
+		debug() << "the statement has several rhs args" << std::endl;
+		compileArithAssign(stmt);
+		return;
+	}
+
+	tree lhs = gimple_assign_lhs(stmt);
+	tree rhs = gimple_assign_rhs1(stmt);
+
+	if (INDIRECT_REF_P(lhs) || TREE_CODE(lhs) == MEM_REF
+		|| TREE_CODE(lhs) == TARGET_MEM_REF) { //this is a mem node
+		// the effect of the store depends on the configuration, it
+		// closes the current segment
+		current();
+		Segment& s = _segments.back();
+		s.pointer = TREE_OPERAND(lhs, 0);
+		s.value = rhs;
+
+		const MayAliasSets* sets = Configuration::mayAliasSets();
+		assert(sets);
+		s.mayAlias = sets->mayAlias(s.pointer);
+		for (tree pointee : sets->knownPointees(s.pointer)) {
+			Constraint c(pointee,EQ_EXPR,rhs);
+			s.knownStores.emplace_back(pointee,
+				Configuration::acceptConstraint(c) ?
+				Configuration::intern(c, Configuration::buildTerm(c)) :
+				InternedConstraint());
+		}
+	} else if (is_gimple_variable(lhs)) {
+		Transfer& t = current();
+		t.kill(lhs);
+
+		if (!gimple_clobber_p(stmt)) {
+			//Special case : int* p; int v; p = &v;
+			//we want to remember that *p is aliased to v
+			if (POINTER_TYPE_P(TREE_TYPE(lhs)) &&
+					TREE_CODE(rhs) == ADDR_EXPR) {
+				t.ptrDestinations.emplace_back(lhs,TREE_OPERAND(rhs,0));
+				Configuration::internVar(lhs);
+			}
+			t.gen(Constraint(lhs,EQ_EXPR,rhs));
+		}
+	} else if (TREE_CODE(lhs) == COMPONENT_REF
+		|| TREE_CODE(lhs) == BIT_FIELD_REF
+		|| TREE_CODE(lhs) == ARRAY_REF)  { //component assignment
+		tree var = TREE_OPERAND(lhs, 0);
+		current().kill(var);
+		// useful ??
+	} else {
+		throw std::runtime_error(std::string("Unhandled assignment: ") + tree_code_name[TREE_CODE(lhs)]);
+	}
+}
+
+void BlockSummary::compileArithAssign(gimple stmt)
+{
+	tree lhs = gimple_assign_lhs(stmt);
+	if (!is_gimple_variable(lhs))
+		return;
+	Transfer& t = current();
+	t.kill(lhs);
+
+	// the operations are interpreted in unbounded integers, which is
+	// only right if they do not wrap around (unsigned and pointer
+	// arithmetic does, e.g. in the overflow checks "a + b < a"). The
+	// overflow of signed integers is undefined in C even when GCC is
+	// told not to rely on it (-fno-strict-overflow, as in the kernel).
+	tree type = TREE_TYPE(lhs);
+	if (!INTEGRAL_TYPE_P(type) || TYPE_OVERFLOW_WRAPS(type))
+		return;
+
+	tree_code code = gimple_assign_rhs_code(stmt);
+	tree rhs1 = gimple_assign_rhs1(stmt);
+	switch (code) {
+		case NEGATE_EXPR:
+			t.gen(Constraint(lhs,EQ_EXPR,rhs1,code));
+			break;
+		case MULT_EXPR:
+			{
+				tree rhs2 = gimple_assign_rhs2(stmt);
+				//we only handle linear arithmetic, one of the
+				//operands must be a constant
+				if (TREE_CODE(rhs1) == INTEGER_CST)
+					std::swap(rhs1,rhs2);
+				if (TREE_CODE(rhs2) == INTEGER_CST)
+					t.gen(Constraint(lhs,EQ_EXPR,rhs1,code,rhs2));
+			}
+			break;
+		case PLUS_EXPR:
+		case MINUS_EXPR:
+			t.gen(Constraint(lhs,EQ_EXPR,rhs1,code,gimple_assign_rhs2(stmt)));
+			break;
+		default:
+			debug() << "Unhandled operation: " << tree_code_name[code] << std::endl;
+	}
+}
+
+void BlockSummary::compilePhi(gimple stmt)
+{
+	tree lhs = gimple_phi_result(stmt);
+	if (!is_gimple_reg(lhs)) //dont care about .MEM phi nodes
+		return;
+
+	for (unsigned int i = 0 ; i < gimple_phi_num_args(stmt) && i < _phis.size() ; i++)
+		_phis[i].gen(Constraint(lhs,EQ_EXPR,gimple_phi_arg_def(stmt, i)));
+}
+
+void BlockSummary::apply(Configuration& k) const
+{
+	if (k.lastEdgeTaken() < _phis.size())
+		_phis[k.lastEdgeTaken()].apply(k);
+
+	for (const Segment& s : _segments) {
+		s.transfer.apply(k);
+		if (s.pointer != NULL_TREE)
+			k.storeThroughPointer(s.pointer, s.mayAlias, s.knownStores);
+	}
+}
@@ -0,0 +1,239 @@
+/**
+ * @file block_summary.h
+ * @brief Definition of the BlockSummary class
+ * @version 0.1
+ */
+#ifndef BLOCK_SUMMARY_H
+#define BLOCK_SUMMARY_H
+
+#include <gcc-plugin.h>
+#include <basic-block.h>
+#include <tree.h>
+#include <gimple.h>
+
+#include <vector>
+#include <utility>
+
+#include <yices.h>
+
+#include "constraint.h"
+#include "may_alias_sets.h"
+#include "var_table.h"
+
+class Configuration;
+
+/**
+ * @brief The effect of a basic block on a configuration, compiled once from
+ * the GIMPLE statements of the block
+ *
+ * A summary is a sequence of segments. Each segment is a transfer, i.e. the
+ * folded effect of consecutive statements that do not depend on the
+ * configuration they are applied to, optionally followed by a store through
+ * a pointer, whose effect depends on whether the configuration knows the
+ * pointee. Most basic blocks compile to a single transfer. The Phi nodes are
+ * compiled into one transfer per incoming edge.
+ *
+ * All the terms and variable identifiers are computed at compilation, so that
+ * a summary can be applied without looking at the GIMPLE code of the
+ * function anymore.
+ */
+class BlockSummary
+{
+	public:
+		/**
+		 * @brief The folded effect of a sequence of statements
+		 *
+		 * Applying a transfer to a configuration forgets all the
+		 * constraints on memory if \a killMem is set, then the
+		 * constraints on the variables in \a kills, records the
+		 * pointer destinations and finally adds the constraints in
+		 * \a gens.
+		 */
+		struct Transfer {
+			/**
+			 * @brief Whether the constraints on all the variables
+			 * living in memory are forgotten
+			 */
+			bool killMem = false;
+			/**
+			 * @brief The variables whose constraints are forgotten
+			 */
+			std::vector<tree> kills;
+			/**
+			 * @brief The pointers whose destination becomes known
+			 */
+			std::vector<std::pair<tree,tree>> ptrDestinations;
+			/**
+			 * @brief The constraints generated, along with their
+			 * interned form
+			 */
+			std::vector<std::pair<Constraint,InternedConstraint>> gens;
+
+			/**
+			 * @brief Tells whether the transfer does nothing
+			 * @return true if, and only if, applying the transfer
+			 * leaves any configuration unchanged
+			 */
+			bool empty() const {
+				return !killMem && kills.empty() &&
+				       ptrDestinations.empty() && gens.empty();
+			}
+			/**
+			 * @brief Appends the effect of forgetting a variable
+			 * @param var the variable
+			 */
+			void kill(tree var);
+			/**
+			 * @brief Appends the effect of forgetting all the
+			 * variables living in memory
+			 */
+			void killMemory();
+			/**
+			 * @brief Appends the effect of generating a constraint
+			 *
+			 * The constraint is discarded if it cannot be
+			 * interpreted by the solver.
+			 * @param c the constraint
+			 */
+			void gen(Constraint c);
+			/**
+			 * @brief Appends the effect of another transfer
+			 * @param other the transfer applied after this one
+			 */
+			void append(const Transfer& other);
+			/**
+			 * @brief Applies the transfer to a configuration
+			 * @param k the configuration
+			 */
+			void apply(Configuration& k) const;
+		};
+
+		/**
+		 * @brief A transfer followed by a store through a pointer
+		 */
+		struct Segment {
+			/**
+			 * @brief The transfer applied first
+			 */
+			Transfer transfer;
+			/**
+			 * @brief The pointer through which the store is done,
+			 * or NULL_TREE if the segment has no store
+			 */
+			tree pointer = NULL_TREE;
+			/**
+			 * @brief The value stored
+			 */
+			tree value = NULL_TREE;
+			/**
+			 * @brief The local variables \a pointer may point to
+			 */
+			LocalVarSet mayAlias;
+			/**
+			 * @brief For each variable \a pointer can be known to
+			 * point to, the constraint stating that the variable
+			 * equals \a value
+			 */
+			std::vector<std::pair<tree,InternedConstraint>> knownStores;
+		};
+
+	private:
+		/**
+		 * @brief The transfer of the Phi nodes, for each incoming
+		 * edge index
+		 */
+		std::vector<Transfer> _phis;
+		/**
+		 * @brief The segments compiled from the statements of the
+		 * basic block
+		 */
+		std::vector<Segment> _segments;
+
+		/**
+		 * @brief Compiles an assignment statement
+		 * @param stmt the gimple assignment statement
+		 */
+		void compileAssign(gimple stmt);
+		/**
+		 * @brief Compiles an assignment statement whose right-hand
+		 * side is an arithmetic operation
+		 *
+		 * Only the linear operations on the integral types that do
+		 * not wrap around are interpreted, the left-hand side of the
+		 * other ones is simply forgotten.
+		 * @param stmt the gimple assignment statement
+		 */
+		void compileArithAssign(gimple stmt);
+		/**
+		 * @brief Compiles a function call
+		 * @param stmt the gimple call statement
+		 */
+		void compileCall(gimple stmt);
+		/**
+		 * @brief Compiles a Phi node
+		 * @param stmt the gimple Phi statement
+		 */
+		void compilePhi(gimple stmt);
+		/**
+		 * @brief Gets the transfer to which the effect of the next
+		 * statement must be appended
+		 * @return the transfer of the last segment, which is created
+		 * if necessary
+		 */
+		Transfer& current();
+
+	public:
+		/**
+		 * @brief Builds an empty summary, which does nothing
+		 */
+		BlockSummary() = default;
+		/**
+		 * @brief Compiles the statements of a basic block
+		 * @param bb the basic block
+		 * @param withPhis whether the Phi nodes must be compiled or
+		 * discarded
+		 */
+		BlockSummary(basic_block bb, bool withPhis);
+		/**
+		 * @brief Applies the summary to a configuration
+		 *
+		 * The Phi nodes are interpreted according to the edge last
+		 * taken by the configuration.
+		 * @param k the configuration
+		 */
+		void apply(Configuration& k) const;
+		/**
+		 * @brief Gets the compiled Phi nodes
+		 * @return the transfer of the Phi nodes for each incoming
+		 * edge index
+		 */
+		const std::vector<Transfer>& phis() const { return _phis; }
+		/**
+		 * @brief Replaces the compiled Phi nodes by a transfer applied
+		 * whatever the edge taken to reach the basic block
+		 * @param t the transfer
+		 * @param edges the number of incoming edges of the basic
+		 * block
+		 */
+		void setEntryTransfer(const Transfer& t, unsigned int edges) {
+			_phis.assign(edges, t);
+		}
+		/**
+		 * @brief Gets the compiled statements
+		 * @return the segments of the summary
+		 */
+		const std::vector<Segment>& segments() const { return _segments; }
+		/**
+		 * @brief Estimates how much the summary constrains a path
+		 * @return the number of constraints generated by the
+		 * statements of the basic block
+		 */
+		unsigned int constraintCount() const {
+			unsigned int n = 0;
+			for (const Segment& s : _segments)
+				n += s.transfer.gens.size() + (s.pointer != NULL_TREE);
+			return n;
+		}
+};
+
+#endif /* ifndef BLOCK_SUMMARY_H */
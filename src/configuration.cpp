@@ -6,15 +6,20 @@
  * @date 2016-03-27
  */
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <utility>
 #include <vector>
 #include <map>
+#include <mutex>
 #include <functional>
+#include <stdexcept>
+#include <string>
 
 #include <cassert>
 #include <cstring>
+#include <cstdint>
 #include <gcc-plugin.h>
 #include <gimple.h>
 #include <tree.h>
@@ -25,138 +30,170 @@
 
 #include "configuration.h"
 #include "constraint.h"
+#include "query_capture.h"
 #include "rich_basic_block.h"
 #include "debug.h"
 
-const type_t Configuration::YICES_INT{yices_int_type()};
+namespace {
+	/**
+	 * @brief Appends the binary representation of a value to a buffer
+	 * @tparam T a trivially copyable type
+	 * @param out the buffer
+	 * @param v the value
+	 */
+	template<typename T>
+	void put(std::string& out, const T& v)
+	{
+		out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+	}
+
+	/**
+	 * @brief Reads a value written by put()
+	 * @tparam T a trivially copyable type
+	 * @param in the position of the value, updated to point right after
+	 * it
+	 * @return the value
+	 */
+	template<typename T>
+	T get(const char*& in)
+	{
+		T v;
+		std::memcpy(&v, in, sizeof(T));
+		in += sizeof(T);
+		return v;
+	}
+
+	/**
+	 * @brief Reads an array of values written contiguously
+	 * @tparam T a trivially copyable type
+	 * @param in the position of the array, updated to point right after
+	 * it
+	 * @param v the vector to fill
+	 * @param n the number of values
+	 */
+	template<typename T>
+	void getArray(const char*& in, std::vector<T>& v, uint32_t n)
+	{
+		v.resize(n);
+		std::memcpy(v.data(), in, n * sizeof(T));
+		in += n * sizeof(T);
+	}
+
+	/**
+	 * @brief Renders an integer in SMT-LIB2, where negative literals do
+	 * not exist
+	 * @param v the integer
+	 * @return the rendering of \a v
+	 */
+	std::string smtInteger(long v)
+	{
+		return v < 0 ? "(- " + std::to_string(-(long long)v) + ")" : std::to_string(v);
+	}
+
+	/**
+	 * @brief Tells whether an SSA name is the result of an arithmetic
+	 * operation interpreted in the integers
+	 *
+	 * Such a result is only bounded by its type, which the solver does
+	 * not know unless it is told.
+	 * @param t an SSA name
+	 * @return true if \a t is defined by a linear operation on a type
+	 * that does not wrap around
+	 */
+	bool definedByArithmetic(tree t)
+	{
+		if (TYPE_OVERFLOW_WRAPS(TREE_TYPE(t)))
+			return false;
+		gimple def = SSA_NAME_DEF_STMT(t);
+		if (!def || !is_gimple_assign(def))
+			return false;
+		switch (gimple_assign_rhs_code(def)) {
+			case PLUS_EXPR:
+			case MINUS_EXPR:
+			case MULT_EXPR:
+			case NEGATE_EXPR:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * @brief Measures the time elapsed since a given instant
+	 * @param start the instant
+	 * @return the number of microseconds elapsed since \a start
+	 */
+	long long elapsedUs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+type_t Configuration::YICES_INT = NULL_TYPE;
 
 std::map<tree,std::string> Configuration::_strings;
 
+thread_local VarTable* Configuration::_vars = nullptr;
+
+std::vector<term_t> Configuration::_namedTerms;
+
+unsigned int Configuration::_ssaCounter = 0;
+
+unsigned int Configuration::_varCounter = 0;
+
+thread_local const MayAliasSets* Configuration::_mayAliasSets = nullptr;
+
+thread_local PathTree* Configuration::_pathTree = nullptr;
+
+std::mutex Configuration::_solverMutex;
+
+unsigned int Configuration::_liveFunctions = 0;
+
+QueryCapture* Configuration::_capture = nullptr;
+
 Configuration::Configuration() :
 	_indexLastEdgeTaken{0}
 {
-	debug() << "Configuration created, _constraints size: " << _constraints.size() << std::endl;
-}
-
-Configuration& Configuration::operator<<(gimple stmt)
-{
-	switch (gimple_code(stmt)) {
-		case GIMPLE_ASSIGN:
-			doGimpleAssign(stmt);
-			break;
-		case GIMPLE_PHI:
-			doGimplePhi(stmt);
-			break;
-		case GIMPLE_CALL:
-			doGimpleCall(stmt);
-			break;
-		case GIMPLE_ASM:
-			resetAllVarMem();
-			break;
-		default:
-			; //nothing to do
-	}
-	return *this;
+	debug() << "Configuration created, constraints: " << _terms.size() << std::endl;
 }
 
 Configuration& Configuration::operator<<(const Constraint& c)
 {
-	switch (c.rel) {
-		case EQ_EXPR:
-		case NE_EXPR:
-		case LT_EXPR:
-		case LE_EXPR:
-		case GT_EXPR:
-		case GE_EXPR:
-			tryAddConstraint(c);
-			break;
-		default:
-			; //we should probably raise an exception here
-			  //it means that we don't handle one of the operator
-			  //or that we mis-parsed the constraint
-	}
+	tryAddConstraint(c);
 	return *this;
 }
 
-void Configuration::doGimpleCall(gimple stmt)
+void Configuration::storeThroughPointer(tree pointer, const LocalVarSet& mayAlias,
+					const std::vector<std::pair<tree,InternedConstraint>>& knownStores)
 {
-	tree lhs = gimple_call_lhs(stmt);
-	if (lhs && lhs != NULL_TREE)
-		resetVar(lhs);
-
-	resetAllVarMem();
-}
-
-void Configuration::doGimpleAssign(gimple stmt)
-{
-	//TODO possibly unsafe
-	if (!gimple_assign_single_p(stmt) && !gimple_assign_cast_p(stmt)) {
-		debug() << "the statement has several rhs args" << std::endl;
-		return; //we can do nothing if stmt is
-			//more than a simple copy (e.g. if it's an operation)
-	}
-
-	tree lhs = gimple_assign_lhs(stmt);
-	tree rhs = gimple_assign_rhs1(stmt);
-
-	if (INDIRECT_REF_P(lhs) || TREE_CODE(lhs) == MEM_REF
-		|| TREE_CODE(lhs) == TARGET_MEM_REF) { //this is a mem node
-		tree pointer = TREE_OPERAND(lhs, 0);
-		auto it = _ptrDestination.find(pointer);
-		if (it != _ptrDestination.end()) {
-			resetVar(it->second);
-			tryAddConstraint(Constraint(it->second,EQ_EXPR,rhs));
-		} else {
-			pt_solution& ptSol = get_ptr_info(pointer)->pt;
-			auto mayDeref = [&ptSol,&pointer](tree var) -> bool {
-				if (ptSol.escaped || ptSol.anything)
-					return alias_sets_conflict_p(get_alias_set(var),get_deref_alias_set(pointer));
-				else
-					return bitmap_bit_p(ptSol.vars, DECL_PT_UID(var));
-			};
-
-			unsigned int ix;
-			tree var;
-			FOR_EACH_LOCAL_DECL(cfun, ix, var) {
-				if (mayDeref(var)) {
-					resetVar(var);
-				}
-			}
-		}
-	} else if (is_gimple_variable(lhs)) {
-		debug() << strForTree(lhs) << " is a variable" << std::endl;
-		resetVar(lhs);
-
-		if (!gimple_clobber_p(stmt)) {
-			//Special case : int* p; int v; p = &v;
-			//we want to remember that *p is aliased to v
-			if (POINTER_TYPE_P(TREE_TYPE(lhs)) &&
-					TREE_CODE(rhs) == ADDR_EXPR) {
-				_ptrDestination.emplace(lhs,TREE_OPERAND(rhs,0));
-			}
-			tryAddConstraint(Constraint(lhs,EQ_EXPR,rhs));
-		}
-	} else if (TREE_CODE(lhs) == COMPONENT_REF
-		|| TREE_CODE(lhs) == BIT_FIELD_REF
-		|| TREE_CODE(lhs) == ARRAY_REF)  { //component assignment
-		tree var = TREE_OPERAND(lhs, 0);
-		resetVar(var);
-		// useful ??
+	auto it = _ptrDestination.find(_vars->lookup(pointer));
+	if (it != _ptrDestination.end()) {
+		tree pointee = it->second;
+		resetVar(pointee);
+		for (const auto& store : knownStores)
+			if (store.first == pointee && store.second.term != NULL_TERM)
+				addConstraint(store.second);
 	} else {
-		throw std::runtime_error(std::string("Unhandled assignment: ") + tree_code_name[TREE_CODE(lhs)]);
+		// kill only the constrained locals the pointer may
+		// point to
+		assert(_mayAliasSets);
+		LocalVarSet killed = mayAlias & _constrainedLocals;
+		killed.forEach([this](unsigned int i) {
+			resetVar(_mayAliasSets->local(i));
+		});
 	}
 }
 
-void Configuration::doGimplePhi(gimple stmt)
+void Configuration::setPointerDestination(tree pointer, tree pointee)
 {
-	tree lhs = gimple_phi_result(stmt);
-	tree rhs = gimple_phi_arg_def(stmt, _indexLastEdgeTaken);
-
-	if (is_gimple_reg(lhs)) //dont care about .MEM phi nodes
-		tryAddConstraint(Constraint(lhs,EQ_EXPR,rhs));
+	// the pointer is interned when the block summaries are compiled
+	VarTable::VarId id = _vars->lookup(pointer);
+	if (id != VarTable::NONE)
+		_ptrDestination.emplace(id, pointee);
 }
 
-void Configuration::doAddConstraint(Constraint c)
+term_t Configuration::buildTerm(const Constraint& c)
 {
 	static const std::map<tree_code, term_t(*)(term_t,term_t)> ops{
 		{GT_EXPR,  yices_arith_gt_atom},
@@ -168,38 +205,155 @@ void Configuration::doAddConstraint(Constraint c)
 	};
 	term_t t;
 
-	t = ops.at(c.rel)(
-		Configuration::getNormalizedTerm(c.lhs),
-		Configuration::getNormalizedTerm(c.rhs)
-	);
+	term_t lhs = Configuration::getNormalizedTerm(c.lhs);
+	term_t rhs = Configuration::getNormalizedRhsTerm(c);
+	t = ops.at(c.rel)(lhs, rhs);
+	if (_capture) {
+		static const std::map<tree_code, const char*> smtOps{
+			{GT_EXPR,  ">"},
+			{LT_EXPR,  "<"},
+			{GE_EXPR,  ">="},
+			{LE_EXPR,  "<="},
+			{EQ_EXPR,  "="},
+			{NE_EXPR,  "distinct"}
+		};
+		_capture->define(t, std::string("(") + smtOps.at(c.rel) + " " +
+				 _capture->text(lhs) + " " + _capture->text(rhs) + ")");
+	}
 	debug() << "After normalization, new constraint: " << std::endl;
 	yices_pp_term(stderr, t, 40, 1, 0);
+	return t;
+}
+
+term_t Configuration::buildKnownFacts(const Constraint& c)
+{
+	std::vector<term_t> facts;
+	for (tree t : {c.lhs, c.rhs, c.rhs2}) {
+		if (!t || TREE_CODE(t) != SSA_NAME)
+			continue;
+		tree type = TREE_TYPE(t);
+		// the other values are bounded by the guards and the
+		// assignments that produce them, or they are unconstrained
+		// anyway: their bounds would only make the terms larger
+		if (INTEGRAL_TYPE_P(type) && definedByArithmetic(t)) {
+			// the bounds of the widest types do not fit in a
+			// signed host integer, they are simply ignored
+			tree min = TYPE_MIN_VALUE(type);
+			tree max = TYPE_MAX_VALUE(type);
+			term_t var = getNormalizedTerm(t);
+			if (min && host_integerp(min, 0)) {
+				facts.push_back(yices_arith_geq_atom(var,
+						yices_int64(tree_low_cst(min, 0))));
+				if (_capture)
+					_capture->define(facts.back(), "(>= " + _capture->text(var) +
+							 " " + smtInteger(tree_low_cst(min, 0)) + ")");
+			}
+			if (max && host_integerp(max, 0)) {
+				facts.push_back(yices_arith_leq_atom(var,
+						yices_int64(tree_low_cst(max, 0))));
+				if (_capture)
+					_capture->define(facts.back(), "(<= " + _capture->text(var) +
+							 " " + smtInteger(tree_low_cst(max, 0)) + ")");
+			}
+		}
+		// nothing is said about the pointers: the points-to
+		// analysis only sets pt.null when NULL itself flows into the
+		// pointer, not for the parameters, the pointers loaded from
+		// memory or the results of the allocators, so the absence of
+		// pt.null does not mean the pointer is not NULL
+	}
+	if (facts.empty())
+		return NULL_TERM;
+	term_t res = yices_and(facts.size(), facts.data());
+	if (_capture) {
+		std::string text = "(and";
+		for (term_t f : facts)
+			text += " " + _capture->text(f);
+		_capture->define(res, text + ")");
+	}
+	return res;
+}
 
-	debug() << "Constraint about to be inserted, size: " << _constraints.size() << std::endl;
-	for (const auto& p : _constraints) {
-		debug() << "\t";
-		yices_pp_term(stderr, p.second, 40, 1, 0);
+term_t Configuration::conjoin(term_t t1, term_t t2)
+{
+	term_t res = yices_and2(t1, t2);
+	if (_capture)
+		_capture->define(res, "(and " + _capture->text(t1) + " " + _capture->text(t2) + ")");
+	return res;
+}
+
+bool Configuration::contradictsType(const Constraint& c)
+{
+	// GIMPLE puts the constant of a condition second
+	if (c.arith != NOP_EXPR ||
+	    !c.lhs || TREE_CODE(c.lhs) != SSA_NAME ||
+	    !c.rhs || TREE_CODE(c.rhs) != INTEGER_CST)
+		return false;
+	tree type = TREE_TYPE(c.lhs);
+	if (!INTEGRAL_TYPE_P(type) || int_fits_type_p(c.rhs, type))
+		return false;
+
+	// a negative constant that does not fit is below the minimum of
+	// the type, a positive one above its maximum
+	bool below = tree_int_cst_sgn(c.rhs) < 0;
+	switch (c.rel) {
+		case EQ_EXPR:
+			return true;
+		case LT_EXPR:
+		case LE_EXPR:
+			return below;
+		case GT_EXPR:
+		case GE_EXPR:
+			return !below;
+		default:
+			return false;
+	}
+}
+
+VarTable::VarId Configuration::internVar(tree t)
+{
+	assert(_vars);
+	return _vars->intern(t, _mayAliasSets);
+}
+
+InternedConstraint Configuration::intern(const Constraint& c, term_t t)
+{
+	InternedConstraint ic;
+	ic.lhs = internVar(c.lhs);
+	ic.rhs = internVar(c.rhs);
+	ic.rhs2 = internVar(c.rhs2);
+	ic.term = t;
+	ic.mem = isMemoryConstraint(c);
+	return ic;
+}
+
+void Configuration::addConstraint(const InternedConstraint& c)
+{
+	debug() << "Constraint about to be inserted, size: " << _terms.size() << std::endl;
+	for (VarTable::VarId id : {c.lhs, c.rhs, c.rhs2}) {
+		int i = _vars->local(id);
+		if (i >= 0)
+			_constrainedLocals.set(i);
 	}
-	_constraints.emplace_back(std::move(c),t);
-	debug() << "Constraint inserted, size: " << _constraints.size() << std::endl;
+	_lhs.push_back(c.lhs);
+	_rhs.push_back(c.rhs);
+	_rhs2.push_back(c.rhs2);
+	_terms.push_back(c.term);
+	_mem.push_back(c.mem);
+	debug() << "Constraint inserted, size: " << _terms.size() << std::endl;
 }
 
 Configuration::operator bool()
 {
-	std::vector<term_t> terms;
 	debug() << "Building the set of constraints" << std::endl;
-	std::transform(_constraints.cbegin(), _constraints.cend(),
-			std::back_inserter(terms),
-			[](const std::pair<Constraint,term_t>& p) {
-				return p.second;
-			}
-	);
+	std::vector<term_t> terms(_terms);
 	debug() << "Set of constraints built" << std::endl;
 	return checkVectorOfConstraints(terms);
 }
 
 bool Configuration::checkVectorOfConstraints(std::vector<term_t>& terms)
 {
+	std::lock_guard<std::mutex> lock(_solverMutex);
 	term_t conjunct = yices_and(terms.size(), terms.data());
 	yices_pp_term(stderr, conjunct, 120, 50, 0);
 	auto context_deleter = [](context_t* c) { yices_free_context(c); };
@@ -209,7 +363,13 @@ bool Configuration::checkVectorOfConstraints(std::vector<term_t>& terms)
 		yices_print_error(stderr);
 		throw std::runtime_error("Assert failed on formula");
 	}
-	bool res = yices_check_context(ctx.get(), nullptr) & (STATUS_SAT | STATUS_UNKNOWN);
+	auto start = std::chrono::steady_clock::now();
+	smt_status_t status = yices_check_context(ctx.get(), nullptr);
+	if (_capture) {
+		_capture->assertAll(terms);
+		_capture->check(NULL_TERM, status, elapsedUs(start));
+	}
+	bool res = status & (STATUS_SAT | STATUS_UNKNOWN);
 
 	if (res)
 		debug() << "Yices says satisfiable" << std::endl;
@@ -218,47 +378,145 @@ bool Configuration::checkVectorOfConstraints(std::vector<term_t>& terms)
 	return res;
 }
 
+std::vector<bool> Configuration::checkWithGuards(const std::vector<term_t>& guards)
+{
+	// e.g. all the successors were rejected without the solver
+	if (guards.empty())
+		return std::vector<bool>();
+
+	std::vector<term_t> terms(_terms);
+	std::lock_guard<std::mutex> lock(_solverMutex);
+	term_t conjunct = yices_and(terms.size(), terms.data());
+	auto context_deleter = [](context_t* c) { yices_free_context(c); };
+	std::unique_ptr<context_t,decltype(context_deleter)&> ctx{yices_new_context(nullptr), context_deleter};
+	if (yices_assert_formula(ctx.get(), conjunct) < 0) {
+		yices_print_error(stderr);
+		throw std::runtime_error("Assert failed on formula");
+	}
+
+	if (_capture)
+		_capture->assertAll(terms);
+
+	auto satisfiable = [&ctx](term_t g) {
+		auto start = std::chrono::steady_clock::now();
+		smt_status_t status = (g == NULL_TERM) ?
+			yices_check_context(ctx.get(), nullptr) :
+			yices_check_context_with_assumptions(ctx.get(), nullptr, 1, &g);
+		if (_capture)
+			_capture->check(g, status, elapsedUs(start));
+		if (status == STATUS_ERROR) {
+			yices_print_error(stderr);
+			throw std::runtime_error("Check failed on formula");
+		}
+		// only a proof of unsatisfiability may drop a successor
+		return status != STATUS_UNSAT;
+	};
+	std::vector<bool> res;
+	// the check without any assumption is shared by all the guards
+	// that cannot be interpreted
+	int unguarded = -1;
+	for (term_t g : guards) {
+		if (g == NULL_TERM) {
+			if (unguarded < 0)
+				unguarded = satisfiable(NULL_TERM);
+			res.push_back(unguarded);
+		} else {
+			res.push_back(satisfiable(g));
+		}
+		debug() << "Yices says " << (res.back() ? "satisfiable" : "unsatisfiable") << std::endl;
+	}
+	return res;
+}
+
+void Configuration::compactConstraints(const std::vector<unsigned char>& keep)
+{
+	// every constraint is copied to the first free slot, which only
+	// moves forward if it is kept
+	size_t n = _terms.size();
+	size_t out = 0;
+	for (size_t i = 0 ; i < n ; i++) {
+		_lhs[out] = _lhs[i];
+		_rhs[out] = _rhs[i];
+		_rhs2[out] = _rhs2[i];
+		_terms[out] = _terms[i];
+		_mem[out] = _mem[i];
+		out += keep[i];
+	}
+	_lhs.resize(out);
+	_rhs.resize(out);
+	_rhs2.resize(out);
+	_terms.resize(out);
+	_mem.resize(out);
+}
+
 void Configuration::resetVar(tree var) {
+	VarTable::VarId id = _vars->lookup(var);
+	if (id == VarTable::NONE) //no constraint can be about var
+		return;
+
 	// erase all constraints about var everywhere
-	_constraints.erase(
-		std::remove_if(_constraints.begin(), _constraints.end(),
-			[&var](const std::pair<Constraint,term_t>& p) {
-				const Constraint& c = p.first;
-				return (c.lhs == var || c.rhs == var);
-			}),
-		_constraints.end()
-	);
+	size_t n = _terms.size();
+	std::vector<unsigned char> keep(n);
+	for (size_t i = 0 ; i < n ; i++)
+		keep[i] = (_lhs[i] != id) & (_rhs[i] != id) & (_rhs2[i] != id);
+	compactConstraints(keep);
 
 	//if var is a pointer, we lose the information about its value
-	_ptrDestination.erase(var);
+	_ptrDestination.erase(id);
+
+	int i = _vars->local(id);
+	if (i >= 0)
+		_constrainedLocals.reset(i);
 }
 
 void Configuration::resetAllVarMem()
 {
-	_constraints.erase(
-		std::remove_if(_constraints.begin(), _constraints.end(),
-			[](const std::pair<Constraint,term_t>& p) {
-				const Constraint& c = p.first;
-				return (!is_gimple_reg(c.lhs) ||
-				        (is_gimple_variable(c.rhs) && !is_gimple_reg(c.rhs)));
-			}),
-		_constraints.end()
-	);
-
+	size_t n = _terms.size();
+	std::vector<unsigned char> keep(n);
+	for (size_t i = 0 ; i < n ; i++)
+		keep[i] = !_mem[i];
+	compactConstraints(keep);
 
 	for (auto it = _ptrDestination.begin() ; it != _ptrDestination.end() ;)
 	{
-		const tree pointer = it->first;
-		if (is_gimple_reg(pointer))
+		if (_vars->isRegister(it->first))
 			++it;
 		else
 			it = _ptrDestination.erase(it);
 	}
+}
 
+bool Configuration::isMemoryConstraint(const Constraint& c)
+{
+	return !is_gimple_reg(c.lhs) ||
+	       (is_gimple_variable(c.rhs) && !is_gimple_reg(c.rhs)) ||
+	       (c.rhs2 && is_gimple_variable(c.rhs2) && !is_gimple_reg(c.rhs2));
 }
 
 bool Configuration::tryAddConstraint(Constraint c)
 {
+	if (!acceptConstraint(c))
+		return false;
+
+	addConstraint(intern(c, buildTerm(c)));
+	return true;
+}
+
+bool Configuration::acceptConstraint(Constraint& c)
+{
+	switch (c.rel) {
+		case EQ_EXPR:
+		case NE_EXPR:
+		case LT_EXPR:
+		case LE_EXPR:
+		case GT_EXPR:
+		case GE_EXPR:
+			break;
+		default:
+			return false; //we don't handle the operator or we
+				      //mis-parsed the constraint
+	}
+
 	debug() << "Trying to add a constraint about " << strForTree(c.lhs)
 		  << "\n\tlhs tree code: " << tree_code_name[TREE_CODE(c.lhs)]
 		  << "\n\trhs tree code: " << tree_code_name[TREE_CODE(c.rhs)]
@@ -266,30 +524,164 @@ bool Configuration::tryAddConstraint(Constraint c)
 
 	c.lhs = STRIP_USELESS_TYPE_CONVERSION(c.lhs);
 	c.rhs = STRIP_USELESS_TYPE_CONVERSION(c.rhs);
+	if (c.rhs2)
+		c.rhs2 = STRIP_USELESS_TYPE_CONVERSION(c.rhs2);
 
-	if (!(is_gimple_variable(c.lhs) || TREE_CODE(c.lhs) == INTEGER_CST || TREE_CODE(c.lhs) == ADDR_EXPR) ||
-	    !(is_gimple_variable(c.rhs) || TREE_CODE(c.rhs) == INTEGER_CST || TREE_CODE(c.lhs) == ADDR_EXPR)) {
+	auto goodNode = [](tree t) {
+		return is_gimple_variable(t) || TREE_CODE(t) == INTEGER_CST || TREE_CODE(t) == ADDR_EXPR;
+	};
+	if (!goodNode(c.lhs) || !goodNode(c.rhs) || (c.rhs2 && !goodNode(c.rhs2))) {
 		debug() << "Bad nodes" << std::endl;
 		return false;
 	}
 
-	if ((DECL_P(c.lhs) && is_global_var(c.lhs)) ||
-            (DECL_P(c.rhs) && is_gimple_variable(c.rhs) && is_global_var(c.rhs))) {
+	auto globalVar = [](tree t) {
+		return DECL_P(t) && is_gimple_variable(t) && is_global_var(t);
+	};
+	if (globalVar(c.lhs) || globalVar(c.rhs) || (c.rhs2 && globalVar(c.rhs2))) {
 		debug() << "Cannot handle global vars" << std::endl;
 		return false;
 	}
 
-	if ((DECL_P(c.lhs) && TREE_THIS_VOLATILE(c.lhs)) ||
-	    (DECL_P(c.rhs) && TREE_THIS_VOLATILE(c.rhs))) {
+	auto volatileVar = [](tree t) {
+		return DECL_P(t) && TREE_THIS_VOLATILE(t);
+	};
+	if (volatileVar(c.lhs) || volatileVar(c.rhs) || (c.rhs2 && volatileVar(c.rhs2))) {
 		debug() << "Cannot handle volatile" << std::endl;
 		return false;
 	}
 
 	debug() << "Constraint accepted" << std::endl;
+	return true;
+}
 
-	doAddConstraint(std::move(c));
+void Configuration::startSolverSession()
+{
+	yices_init();
+	YICES_INT = yices_int_type();
+}
 
-	return true;
+void Configuration::endSolverSession()
+{
+	_strings.clear();
+	_namedTerms.clear();
+	YICES_INT = NULL_TYPE;
+	yices_exit();
+}
+
+void Configuration::beginFunction()
+{
+	_liveFunctions++;
+}
+
+void Configuration::releaseFunctionNames()
+{
+	for (term_t t : _namedTerms)
+		yices_clear_term_name(t);
+	debug() << "Releasing " << _namedTerms.size() << " named terms" << std::endl;
+	_namedTerms.clear();
+	_strings.clear();
+	_ssaCounter = 0;
+	_varCounter = 0;
+}
+
+void Configuration::endFunction()
+{
+	std::lock_guard<std::mutex> lock(_solverMutex);
+	if (--_liveFunctions > 0)
+		return;
+
+	// no term is referenced anymore, the types are kept since they
+	// are only the primitive ones
+	yices_garbage_collect(nullptr, 0, nullptr, 0, false);
+	if (_capture)
+		_capture->forgetTerms();
+}
+
+void Configuration::setQueryCapture(QueryCapture* capture)
+{
+	_capture = capture;
+}
+
+void Configuration::setMayAliasSets(const MayAliasSets* sets)
+{
+	_mayAliasSets = sets;
+}
+
+void Configuration::serialize(std::string& out) const
+{
+	put(out, _indexLastEdgeTaken);
+	// the path itself is written, the nodes of the path tree can then
+	// be recycled while the configuration is on disk
+	std::vector<RichBasicBlock*> bbs = path();
+	put(out, uint32_t(bbs.size()));
+	for (RichBasicBlock* bb : bbs)
+		put(out, bb);
+
+	put(out, uint32_t(_terms.size()));
+	out.append(reinterpret_cast<const char*>(_lhs.data()), _lhs.size() * sizeof(VarTable::VarId));
+	out.append(reinterpret_cast<const char*>(_rhs.data()), _rhs.size() * sizeof(VarTable::VarId));
+	out.append(reinterpret_cast<const char*>(_rhs2.data()), _rhs2.size() * sizeof(VarTable::VarId));
+	out.append(reinterpret_cast<const char*>(_terms.data()), _terms.size() * sizeof(term_t));
+	out.append(reinterpret_cast<const char*>(_mem.data()), _mem.size());
+
+	put(out, uint32_t(_ptrDestination.size()));
+	for (const auto& p : _ptrDestination) {
+		put(out, p.first);
+		put(out, p.second);
+	}
+
+	put(out, uint32_t(_constrainedLocals.words().size()));
+	for (LocalVarSet::word_t w : _constrainedLocals.words())
+		put(out, w);
+
+	put(out, uint32_t(_takenGuards.size()));
+	for (unsigned int id : _takenGuards)
+		put(out, id);
+}
+
+Configuration Configuration::deserialize(const char*& in)
+{
+	Configuration k;
+	k._indexLastEdgeTaken = get<unsigned int>(in);
+	uint32_t n = get<uint32_t>(in);
+	assert(_pathTree || n == 0);
+	for (uint32_t i = 0 ; i < n ; i++)
+		k._path = _pathTree->extend(k._path, get<RichBasicBlock*>(in));
+
+	n = get<uint32_t>(in);
+	getArray(in, k._lhs, n);
+	getArray(in, k._rhs, n);
+	getArray(in, k._rhs2, n);
+	getArray(in, k._terms, n);
+	getArray(in, k._mem, n);
+
+	n = get<uint32_t>(in);
+	for (uint32_t i = 0 ; i < n ; i++) {
+		VarTable::VarId pointer = get<VarTable::VarId>(in);
+		k._ptrDestination.emplace_hint(k._ptrDestination.end(), pointer, get<tree>(in));
+	}
+
+	n = get<uint32_t>(in);
+	k._constrainedLocals.words().resize(n);
+	for (uint32_t i = 0 ; i < n ; i++)
+		k._constrainedLocals.words()[i] = get<LocalVarSet::word_t>(in);
+
+	n = get<uint32_t>(in);
+	k._takenGuards.reserve(n);
+	for (uint32_t i = 0 ; i < n ; i++)
+		k._takenGuards.push_back(get<unsigned int>(in));
+	return k;
+}
+
+void Configuration::setVarTable(VarTable* vars)
+{
+	_vars = vars;
+}
+
+void Configuration::setPathTree(PathTree* tree)
+{
+	_pathTree = tree;
 }
 
 const std::string& Configuration::strForTree(tree t)
@@ -298,21 +690,18 @@ const std::string& Configuration::strForTree(tree t)
 	if (it != _strings.end())
 		return it->second;
 
-	static unsigned int ssaCounter = 0;
-	static unsigned int varCounter = 0;
-
 	std::string res;
 	if (TREE_CODE(t) == SSA_NAME) {
 		tree name = SSA_NAME_IDENTIFIER(t);
 		if (!name || name == NULL_TREE || strlen(IDENTIFIER_POINTER(name)) == 0)
-			res = "<ssa " + std::to_string(ssaCounter++) + ">";
+			res = "<ssa " + std::to_string(_ssaCounter++) + ">";
 		else
 			res = IDENTIFIER_POINTER(name);
 		res += "." + std::to_string(SSA_NAME_VERSION(t));
 	} else if (TREE_CODE(t) == VAR_DECL) {
 		tree name = DECL_NAME(t);
 		if (!name || name == NULL_TREE || strlen(IDENTIFIER_POINTER(name)) == 0)
-			res = "<var " + std::to_string(varCounter++) + ">";
+			res = "<var " + std::to_string(_varCounter++) + ">";
 		else
 			res = IDENTIFIER_POINTER(name);
 	} else if (TREE_CODE(t) == ADDR_EXPR) {
@@ -334,9 +723,14 @@ term_t Configuration::getNormalizedTerm(tree t)
 		if (res == NULL_TERM) {
 			res = yices_new_uninterpreted_term(YICES_INT);
 			yices_set_term_name(res, s.c_str());
+			_namedTerms.push_back(res);
+			if (_capture)
+				_capture->declare(res, s);
 		}
 	} else if (TREE_CODE(t) == INTEGER_CST) {
 		res = yices_int64(TREE_INT_CST(t).to_shwi());
+		if (_capture)
+			_capture->define(res, smtInteger(TREE_INT_CST(t).to_shwi()));
 	}
 	debug() << "Normalized term " << strForTree(t) << std::endl;
 	yices_pp_term(stderr, res, 120, 50, 0);
@@ -344,19 +738,56 @@ term_t Configuration::getNormalizedTerm(tree t)
 	return res;
 }
 
+term_t Configuration::getNormalizedRhsTerm(const Constraint& c)
+{
+	term_t rhs = getNormalizedTerm(c.rhs);
+	term_t rhs2 = NULL_TERM;
+	term_t res = rhs;
+	const char* op = nullptr;
+	switch (c.arith) {
+		case PLUS_EXPR:
+			rhs2 = getNormalizedTerm(c.rhs2);
+			res = yices_add(rhs, rhs2);
+			op = "+";
+			break;
+		case MINUS_EXPR:
+			rhs2 = getNormalizedTerm(c.rhs2);
+			res = yices_sub(rhs, rhs2);
+			op = "-";
+			break;
+		case MULT_EXPR:
+			rhs2 = getNormalizedTerm(c.rhs2);
+			res = yices_mul(rhs, rhs2);
+			op = "*";
+			break;
+		case NEGATE_EXPR:
+			res = yices_neg(rhs);
+			op = "-";
+			break;
+		default:
+			; //the right-hand side is a single operand
+	}
+	if (_capture && op)
+		_capture->define(res, std::string("(") + op + " " + _capture->text(rhs) +
+				 (rhs2 != NULL_TERM ? " " + _capture->text(rhs2) : "") + ")");
+	return res;
+}
+
 void Configuration::setPredecessorInfo(RichBasicBlock* rbb, unsigned int edgeTaken)
 {
-	_preds.push_back(rbb);
+	assert(_pathTree);
+	_path = _pathTree->extend(_path, rbb);
 	_indexLastEdgeTaken = edgeTaken;
 }
 
 void Configuration::printPath(std::ostream& out)
 {
+	std::vector<RichBasicBlock*> preds = path();
 	out << "[";
-	auto it = _preds.begin();
-	if (it != _preds.end())
-		out << **it;
-	for (++it; it != _preds.end() ; ++it)
+	auto it = preds.begin();
+	if (it != preds.end())
+		out << **it++;
+	for (; it != preds.end() ; ++it)
 		out << ", " << **it;
 	out << "]";
 }
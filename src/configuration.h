@@ -15,12 +15,19 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <string>
 #include <set>
 #include <utility>
 #include <limits>
 #include <yices.h>
 
+#include "may_alias_sets.h"
+#include "path_tree.h"
+#include "var_table.h"
+
 struct Constraint;
+class QueryCapture;
 class RichBasicBlock;
 
 /**
@@ -32,22 +39,64 @@ class Configuration
 	private:
 		/**
 		 * @brief The set of constraints accumulated so far in the
-		 * configuration
+		 * configuration, stored as parallel arrays
 		 *
-		 * Each constraint is associated with the corresponding term
-		 * which can be interpreted by Yices, a SMT solver.
+		 * Each constraint is represented by the identifiers of its
+		 * variables (\a _lhs, \a _rhs and \a _rhs2), the
+		 * corresponding term which can be interpreted by Yices, a SMT
+		 * solver (\a _terms) and whether it is about a variable living
+		 * in memory (\a _mem). The arrays can thus be filtered
+		 * without branching nor dereferencing any tree.
+		 */
+		std::vector<VarTable::VarId> _lhs;
+		std::vector<VarTable::VarId> _rhs;
+		std::vector<VarTable::VarId> _rhs2;
+		std::vector<term_t> _terms;
+		std::vector<unsigned char> _mem;
+		/**
+		 * @brief The variables of the function under analysis, as
+		 * set by the thread analyzing it
 		 */
-		std::vector<std::pair<Constraint,term_t>> _constraints;
+		static thread_local VarTable* _vars;
 		/**
 		 * @brief A memoization map to record the name assigned to
 		 * variables on which constraints are stored
+		 *
+		 * This map is reset at the end of the analysis of each
+		 * function because GCC may recycle the trees.
 		 */
 		static std::map<tree,std::string> _strings;
+		/**
+		 * @brief The Yices terms named after variables of the
+		 * function under analysis
+		 */
+		static std::vector<term_t> _namedTerms;
+		/**
+		 * @brief Counter used to name the anonymous SSA names
+		 */
+		static unsigned int _ssaCounter;
+		/**
+		 * @brief Counter used to name the anonymous variables
+		 */
+		static unsigned int _varCounter;
 		/**
 		 * @brief A mapping between pointer variables and the variables
 		 * they point to, if this information is known unambiguously
 		 */
-		std::map<tree,tree> _ptrDestination;
+		std::map<VarTable::VarId,tree> _ptrDestination;
+		/**
+		 * @brief The local variables on which constraints may have
+		 * been accumulated
+		 *
+		 * This is an over-approximation, used to find which
+		 * constraints are killed by a store through a pointer.
+		 */
+		LocalVarSet _constrainedLocals;
+		/**
+		 * @brief The may-alias sets of the pointers of the function
+		 * under analysis
+		 */
+		static thread_local const MayAliasSets* _mayAliasSets;
 		/**
 		 * @brief The index of the edge taken to reach the basic block
 		 * currently under analysis
@@ -57,45 +106,117 @@ class Configuration
 		 */
 		unsigned int _indexLastEdgeTaken;
 		/**
-		 * @brief The path followed so far to generate the current
-		 * configuration
+		 * @brief The last node of the path followed so far to
+		 * generate the current configuration, shared with all the
+		 * configurations forked from the same prefix
+		 */
+		PathTree::Ref _path;
+		/**
+		 * @brief The tree where the path prefixes of the walk under
+		 * way in the current thread are recorded
+		 */
+		static thread_local PathTree* _pathTree;
+		/**
+		 * @brief The identifiers of the correlated edges taken so far
+		 * on the path
+		 * @see CorrelatedBranches
 		 */
-		std::vector<RichBasicBlock*> _preds;
+		std::vector<unsigned int> _takenGuards;
 
 		/**
 		 * @brief The type of integral values, the only type we know
 		 * about
+		 *
+		 * This is only valid once the solver session is started.
 		 */
-		const static type_t YICES_INT;
-
+		static type_t YICES_INT;
 		/**
-		 * @brief Handle the case of assignment statements
-		 * @param stmt the gimple assignment statement
+		 * @brief The mutex protecting all the calls to Yices, which
+		 * is not thread-safe
 		 */
-		void doGimpleAssign(gimple stmt);
+		static std::mutex _solverMutex;
 		/**
-		 * @brief Handle the case of Phi statements
-		 * @param stmt the gimple Phi statement
+		 * @brief The number of functions whose terms may still be in
+		 * use, either because they are being compiled or because
+		 * their paths are being walked
+		 *
+		 * It is protected by \a _solverMutex.
 		 */
-		void doGimplePhi(gimple stmt);
+		static unsigned int _liveFunctions;
 		/**
-		 * @brief Handle the function calls
-		 * @param stmt the gimple call statement
+		 * @brief The log of the queries sent to the solver, or
+		 * nullptr if they are not captured
+		 *
+		 * It is protected by \a _solverMutex.
 		 */
-		void doGimpleCall(gimple stmt);
+		static QueryCapture* _capture;
+
 		/**
-		 * @brief Actually adds a constraint to this configuration,
-		 * after all care has been taken
-		 * @param c the constraint, which is passed by value and then
-		 * moved into \a _constraints
+		 * @brief Removes the constraints which are not kept
+		 * @param keep for each constraint, 1 if it is kept, 0
+		 * otherwise
 		 */
-		void doAddConstraint(Constraint c);
+		void compactConstraints(const std::vector<unsigned char>& keep);
 
 	public:
 		/**
 		 * @brief Builds an empty configuration
 		 */
 		Configuration();
+		/**
+		 * @brief Initializes Yices, the SMT solver, for the whole
+		 * compilation
+		 */
+		static void startSolverSession();
+		/**
+		 * @brief Frees all the resources held by Yices, at the end
+		 * of the compilation
+		 */
+		static void endSolverSession();
+		/**
+		 * @brief Gets the mutex which must be held to call Yices
+		 * @return the solver mutex
+		 */
+		static std::mutex& solverMutex() { return _solverMutex; }
+		/**
+		 * @brief Sets the log where the queries sent to the solver
+		 * are captured
+		 *
+		 * The capture must be set before any term is built.
+		 * @param capture the log, or nullptr to stop capturing
+		 */
+		static void setQueryCapture(QueryCapture* capture);
+		/**
+		 * @brief Builds the conjunction of two terms
+		 * @param t1 a term
+		 * @param t2 a term
+		 * @return the term representing \a t1 and \a t2
+		 */
+		static term_t conjoin(term_t t1, term_t t2);
+		/**
+		 * @brief Records that the terms of a new function are about
+		 * to be built
+		 *
+		 * The solver mutex must be held.
+		 */
+		static void beginFunction();
+		/**
+		 * @brief Forgets all the names given to the terms of the
+		 * function under analysis, once all its terms are built
+		 *
+		 * The solver mutex must be held. The terms themselves remain
+		 * valid until endFunction() is called.
+		 */
+		static void releaseFunctionNames();
+		/**
+		 * @brief Records that the terms of a function are not used
+		 * anymore, and lets Yices garbage-collect all the terms if no
+		 * other function is being analyzed
+		 *
+		 * No configuration built for the function must be alive when
+		 * this method is called.
+		 */
+		static void endFunction();
 		/**
 		 * @brief Returns the string representing a variable
 		 * @param t the variable
@@ -108,6 +229,84 @@ class Configuration
 		 * @return a Yices named term representing \a t
 		 */
 		static term_t getNormalizedTerm(tree t);
+		/**
+		 * @brief Gets a Yices term for the right-hand side of a
+		 * constraint, which may be a linear term
+		 *
+		 * The operations are interpreted in unbounded integers, the
+		 * constraints must only use them where they cannot wrap
+		 * around.
+		 * @param c the constraint
+		 * @return a Yices term representing the right-hand side of
+		 * \a c
+		 */
+		static term_t getNormalizedRhsTerm(const Constraint& c);
+		/**
+		 * @brief Sets the may-alias sets to use to interpret the
+		 * stores through pointers in the function under analysis
+		 * @param sets the may-alias sets of the current function,
+		 * which must outlive all the configurations built for it
+		 */
+		static void setMayAliasSets(const MayAliasSets* sets);
+		/**
+		 * @brief Gets the may-alias sets of the function under
+		 * analysis in the current thread
+		 * @return the may-alias sets, or nullptr if they are not set
+		 */
+		static const MayAliasSets* mayAliasSets() { return _mayAliasSets; }
+		/**
+		 * @brief Sets the table in which the variables of the
+		 * function under analysis in the current thread are interned
+		 * @param vars the variable table, which must outlive all the
+		 * configurations built for the function
+		 */
+		static void setVarTable(VarTable* vars);
+		/**
+		 * @brief Gets the table in which the variables of the
+		 * function under analysis in the current thread are interned
+		 * @return the variable table, or nullptr if it is not set
+		 */
+		static const VarTable* varTable() { return _vars; }
+		/**
+		 * @brief Interns a variable in the current variable table
+		 * @param t a tree
+		 * @return the identifier of \a t, or VarTable::NONE if it is
+		 * not a variable
+		 */
+		static VarTable::VarId internVar(tree t);
+		/**
+		 * @brief Interns the variables of a constraint
+		 * @param c a constraint, accepted by acceptConstraint()
+		 * @param t the term representing \a c, as built by
+		 * buildTerm(), or NULL_TERM
+		 * @return the interned constraint
+		 */
+		static InternedConstraint intern(const Constraint& c, term_t t);
+		/**
+		 * @brief Sets the tree in which the paths followed by the
+		 * configurations are recorded
+		 * @param tree the path tree, which must outlive all the
+		 * configurations built while it is set
+		 */
+		static void setPathTree(PathTree* tree);
+		/**
+		 * @brief Appends a compact binary record of this
+		 * configuration to a buffer
+		 *
+		 * The record refers to trees, terms and path nodes by
+		 * address or identifier, it can only be read back by the
+		 * same process, while the function is under analysis.
+		 * @param out the buffer
+		 */
+		void serialize(std::string& out) const;
+		/**
+		 * @brief Rebuilds a configuration from a record written by
+		 * serialize()
+		 * @param in the beginning of the record, which is updated to
+		 * point right after it
+		 * @return the configuration
+		 */
+		static Configuration deserialize(const char*& in);
 		/**
 		 * @brief Tests whether the configuration is satisfiable
 		 * @return true if, and only if, Yices decides that the
@@ -115,6 +314,20 @@ class Configuration
 		 * satisfiable
 		 */
 		explicit operator bool();
+		/**
+		 * @brief Tests, for each guard of a list, whether the
+		 * configuration extended with the guard is satisfiable
+		 *
+		 * The constraints of the configuration are asserted only once
+		 * in a solver context, and each guard is checked as an
+		 * assumption on top of them.
+		 * @param guards the terms of the guards, NULL_TERM standing
+		 * for a guard which cannot be interpreted
+		 * @return for each guard, true if, and only if, Yices decides
+		 * that the conjunction of the constraints and the guard is
+		 * satisfiable
+		 */
+		std::vector<bool> checkWithGuards(const std::vector<term_t>& guards);
 		/**
 		 * @brief Forget all constraints about the variable passed as
 		 * a parameter
@@ -126,6 +339,80 @@ class Configuration
 		 * lives in memory/are aliasable
 		 */
 		void resetAllVarMem();
+		/**
+		 * @brief Tells whether a constraint is about a variable living
+		 * in memory, and is thus forgotten by resetAllVarMem()
+		 * @param c a constraint
+		 * @return true if, and only if, one of the variables of \a c
+		 * is not a register
+		 */
+		static bool isMemoryConstraint(const Constraint& c);
+		/**
+		 * @brief Interprets a store through a pointer
+		 *
+		 * If the pointee is known, it is constrained to be equal to
+		 * the value stored, otherwise all the constrained local
+		 * variables the pointer may point to are forgotten.
+		 * @param pointer the pointer through which the store is done
+		 * @param mayAlias the may-alias set of \a pointer
+		 * @param knownStores for each variable \a pointer can be
+		 * known to point to, the constraint stating that the variable
+		 * equals the value stored
+		 */
+		void storeThroughPointer(tree pointer, const LocalVarSet& mayAlias,
+					 const std::vector<std::pair<tree,InternedConstraint>>& knownStores);
+		/**
+		 * @brief Records the variable a pointer points to
+		 * @param pointer the pointer
+		 * @param pointee the variable whose address is in \a pointer
+		 */
+		void setPointerDestination(tree pointer, tree pointee);
+		/**
+		 * @brief Verifies the validity of a constraint and normalizes
+		 * it
+		 * @param c a constraint, whose operands are stripped from
+		 * useless conversions
+		 * @return true if, and only if, the constraint can be
+		 * interpreted by the solver
+		 */
+		static bool acceptConstraint(Constraint& c);
+		/**
+		 * @brief Builds the Yices term representing a constraint
+		 * @param c a constraint, accepted by acceptConstraint()
+		 * @return the Yices term representing \a c
+		 */
+		static term_t buildTerm(const Constraint& c);
+		/**
+		 * @brief Builds the Yices term representing what GCC knows
+		 * about the SSA names of a constraint, whatever the path
+		 *
+		 * The facts are the range of the type of the integral SSA
+		 * names computed by the arithmetic operations the
+		 * constraints interpret, the only ones the solver could take
+		 * out of their range. GCC 4.8 does not keep the ranges
+		 * computed by VRP past the pass.
+		 * @param c a constraint, accepted by acceptConstraint()
+		 * @return the conjunction of the facts, or NULL_TERM if
+		 * nothing is known about the operands of \a c
+		 */
+		static term_t buildKnownFacts(const Constraint& c);
+		/**
+		 * @brief Tells whether a guard compares an SSA name to a
+		 * constant outside its type in a way that never holds
+		 *
+		 * This is decided on the trees, with int_fits_type_p(),
+		 * without the solver.
+		 * @param c a constraint
+		 * @return true if \a c can never hold, false if it may
+		 */
+		static bool contradictsType(const Constraint& c);
+		/**
+		 * @brief Actually adds a constraint to this configuration,
+		 * after all care has been taken
+		 * @param c the constraint, as interned by intern(), whose
+		 * term is not NULL_TERM
+		 */
+		void addConstraint(const InternedConstraint& c);
 		/**
 		 * @brief Verifies the validity of a constraint and adds it
 		 * @param c a constraint
@@ -147,6 +434,23 @@ class Configuration
 		 * Phi nodes in \a rbb)
 		 */
 		void setPredecessorInfo(RichBasicBlock* rbb, unsigned int edgeTaken);
+		/**
+		 * @brief Gets the index of the edge taken to reach the basic
+		 * block under analysis
+		 * @return the index of the edge in the predecessors of the
+		 * basic block
+		 */
+		unsigned int lastEdgeTaken() const { return _indexLastEdgeTaken; }
+		/**
+		 * @brief Records that a correlated edge was taken on the path
+		 * @param id the identifier of the edge
+		 */
+		void addTakenGuard(unsigned int id) { _takenGuards.push_back(id); }
+		/**
+		 * @brief Gets the correlated edges taken on the path
+		 * @return the identifiers of the correlated edges taken so far
+		 */
+		const std::vector<unsigned int>& takenGuards() const { return _takenGuards; }
 		/**
 		 * @brief Outputs the path followed to build the current
 		 * configuration
@@ -154,6 +458,12 @@ class Configuration
 		 * printed
 		 */
 		void printPath(std::ostream& out = std::cout);
+		/**
+		 * @brief Gets the path followed to build the current
+		 * configuration
+		 * @return the basic blocks of the path, from the root
+		 */
+		std::vector<RichBasicBlock*> path() const { return PathTree::materialize(_path.get()); }
 		/**
 		 * @brief Tests whether a conjunction of constraints is
 		 * unsatisfiable
@@ -162,13 +472,6 @@ class Configuration
 		 * constraints in \a terms is satisfiable
 		 */
 		static bool checkVectorOfConstraints(std::vector<term_t>& terms);
-		/**
-		 * @brief Interpret a gimple statement to add and remove
-		 * constraints from this configuration accordingly
-		 * @param stmt a gimple statement
-		 * @return this configuration itself
-		 */
-		Configuration& operator<<(gimple stmt);
 		/**
 		 * @brief Adds a constraint to this configuration if it is valid
 		 *
@@ -23,6 +23,14 @@ Constraint::Constraint(tree lhs, tree_code rel, tree rhs) :
 	rhs(rhs)
 {}
 
+Constraint::Constraint(tree lhs, tree_code rel, tree rhs, tree_code arith, tree rhs2) :
+	lhs(lhs),
+	rel(rel),
+	rhs(rhs),
+	arith(arith),
+	rhs2(rhs2)
+{}
+
 Constraint::Constraint(edge e)
 {
 	basic_block src = e->src;
@@ -45,5 +53,6 @@ Constraint::Constraint(edge e)
 
 bool operator<(const Constraint& c1, const Constraint& c2)
 {
-	return std::tie(c1.lhs,c1.rel,c1.rhs) < std::tie(c2.lhs,c2.rel,c2.rhs);
+	return std::tie(c1.lhs,c1.rel,c1.rhs,c1.arith,c1.rhs2) <
+	       std::tie(c2.lhs,c2.rel,c2.rhs,c2.arith,c2.rhs2);
 }
@@ -42,6 +42,26 @@ struct Constraint {
 	 * integer value or an adress-of
 	 */
 	tree rhs;
+	/**
+	 * @brief the arithmetic operator applied to the right-hand side,
+	 * making it a linear term
+	 *
+	 * The accepted values are:
+	 * <ul>
+	 * <li><code>NOP_EXPR</code>: the right-hand side is \a rhs alone</li>
+	 * <li><code>PLUS_EXPR</code>: \a rhs + \a rhs2</li>
+	 * <li><code>MINUS_EXPR</code>: \a rhs - \a rhs2</li>
+	 * <li><code>MULT_EXPR</code>: \a rhs * \a rhs2, where \a rhs2 is
+	 * an integer value</li>
+	 * <li><code>NEGATE_EXPR</code>: - \a rhs</li>
+	 * </ul>
+	 */
+	tree_code arith = NOP_EXPR;
+	/**
+	 * @brief the second operand of the right-hand side, only for binary
+	 * arithmetic operators
+	 */
+	tree rhs2 = NULL_TREE;
 
 	/**
 	 * @brief Builds an empty, invalid constraint
@@ -59,14 +79,24 @@ struct Constraint {
 	 * @param rhs the right-hand side
 	 */
 	Constraint(tree lhs, tree_code rel, tree rhs);
+	/**
+	 * @brief Builds a constraint whose right-hand side is a linear term
+	 * @param lhs the left-hand side
+	 * @param rel the relational operator
+	 * @param rhs the first operand of the right-hand side
+	 * @param arith the arithmetic operator of the right-hand side
+	 * @param rhs2 the second operand of the right-hand side, if \a arith
+	 * is a binary operator
+	 */
+	Constraint(tree lhs, tree_code rel, tree rhs, tree_code arith, tree rhs2 = NULL_TREE);
 	/**
 	 * @brief Compares two Constraint lexicographically
 	 *
 	 * This operator is provided for containers like std::map or std::set.
 	 * @param c1 one constraint
 	 * @param c2 another
-	 * @return true if, and only if, \a c1 = (lhs1,rel1,rhs1) is
-	 * lexicographically lesser than \a c2 = (lhs2,rel2,rhs2)
+	 * @return true if, and only if, \a c1 = (lhs1,rel1,rhs1,arith1,rhs2_1)
+	 * is lexicographically lesser than \a c2 = (lhs2,rel2,rhs2,arith2,rhs2_2)
 	 */
 	friend bool operator<(const Constraint& c1, const Constraint& c2);
 };
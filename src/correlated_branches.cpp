@@ -0,0 +1,194 @@
+/**
+ * @file correlated_branches.cpp
+ * @brief Implementation of the CorrelatedBranches class
+ * @version 0.1
+ */
+#include <cstdlib>
+#include <gcc-plugin.h>
+#include <basic-block.h>
+#include <tree.h>
+#include <gimple.h>
+#include <tree-flow.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "correlated_branches.h"
+#include "constraint.h"
+#include "debug.h"
+
+namespace {
+	/**
+	 * @brief Gets the relational operator obtained by swapping the
+	 * operands of a comparison
+	 * @param rel a relational operator
+	 * @return the operator \a r such that a \a rel b is equivalent to
+	 * b \a r a
+	 */
+	tree_code swapRel(tree_code rel)
+	{
+		switch (rel) {
+			case LT_EXPR: return GT_EXPR;
+			case LE_EXPR: return GE_EXPR;
+			case GT_EXPR: return LT_EXPR;
+			case GE_EXPR: return LE_EXPR;
+			default: return rel;
+		}
+	}
+
+	/**
+	 * @brief Gets the set of orderings between two values allowed by a
+	 * relational operator
+	 * @param rel a relational operator
+	 * @return a mask where the bit 2 stands for "lesser than", the bit 1
+	 * for "equal" and the bit 0 for "greater than"
+	 */
+	unsigned int relMask(tree_code rel)
+	{
+		switch (rel) {
+			case LT_EXPR: return 4;
+			case LE_EXPR: return 6;
+			case EQ_EXPR: return 2;
+			case NE_EXPR: return 5;
+			case GE_EXPR: return 3;
+			case GT_EXPR: return 1;
+			default: return 7;
+		}
+	}
+
+	/**
+	 * @brief Gets the interval of values allowed by a comparison with
+	 * a constant
+	 * @param rel a relational operator other than NE_EXPR
+	 * @param c the constant, which must not be one of the bounds of the
+	 * type long
+	 * @return the interval [lo,hi] of values v such that v \a rel \a c
+	 */
+	std::pair<long,long> interval(tree_code rel, long c)
+	{
+		const long min = std::numeric_limits<long>::min();
+		const long max = std::numeric_limits<long>::max();
+		switch (rel) {
+			case LT_EXPR: return std::make_pair(min, c - 1);
+			case LE_EXPR: return std::make_pair(min, c);
+			case GT_EXPR: return std::make_pair(c + 1, max);
+			case GE_EXPR: return std::make_pair(c, max);
+			default: return std::make_pair(c, c);
+		}
+	}
+}
+
+bool CorrelatedBranches::normalize(Constraint& c)
+{
+	if (relMask(c.rel) == 7)
+		return false;
+
+	if (TREE_CODE(c.lhs) != SSA_NAME) {
+		std::swap(c.lhs, c.rhs);
+		c.rel = swapRel(c.rel);
+	}
+	if (TREE_CODE(c.lhs) != SSA_NAME)
+		return false;
+
+	// the guards on floating point values cannot be inverted so simply
+	tree type = TREE_TYPE(c.lhs);
+	if (!INTEGRAL_TYPE_P(type) && !POINTER_TYPE_P(type))
+		return false;
+
+	if (TREE_CODE(c.rhs) == SSA_NAME) {
+		if (SSA_NAME_VERSION(c.rhs) < SSA_NAME_VERSION(c.lhs)) {
+			std::swap(c.lhs, c.rhs);
+			c.rel = swapRel(c.rel);
+		}
+		return true;
+	}
+
+	// the bounds are excluded so that the intervals never overflow
+	return TREE_CODE(c.rhs) == INTEGER_CST &&
+	       host_integerp(c.rhs, 0) &&
+	       tree_low_cst(c.rhs, 0) != std::numeric_limits<long>::min() &&
+	       tree_low_cst(c.rhs, 0) != std::numeric_limits<long>::max();
+}
+
+bool CorrelatedBranches::contradict(const Constraint& c1, const Constraint& c2)
+{
+	if (TREE_CODE(c1.rhs) == SSA_NAME || TREE_CODE(c2.rhs) == SSA_NAME)
+		return c1.rhs == c2.rhs && (relMask(c1.rel) & relMask(c2.rel)) == 0;
+
+	long v1 = tree_low_cst(c1.rhs, 0);
+	long v2 = tree_low_cst(c2.rhs, 0);
+	if (c1.rel == NE_EXPR && c2.rel == NE_EXPR)
+		return false;
+	if (c1.rel == NE_EXPR)
+		return interval(c2.rel, v2) == std::make_pair(v1, v1);
+	if (c2.rel == NE_EXPR)
+		return interval(c1.rel, v1) == std::make_pair(v2, v2);
+
+	std::pair<long,long> i1 = interval(c1.rel, v1);
+	std::pair<long,long> i2 = interval(c2.rel, v2);
+	return std::max(i1.first, i2.first) > std::min(i1.second, i2.second);
+}
+
+void CorrelatedBranches::computeForCurrentFunction()
+{
+	_ids.clear();
+	_guards.clear();
+	_contradictions.clear();
+
+	std::map<tree,std::vector<unsigned int>> byVariable;
+	basic_block bb;
+	FOR_EACH_BB(bb) {
+		gimple last = last_stmt(bb);
+		if (!last || gimple_code(last) != GIMPLE_COND)
+			continue;
+
+		edge e;
+		edge_iterator it;
+		FOR_EACH_EDGE(e, it, bb->succs) {
+			Constraint c(e);
+			if (!normalize(c))
+				continue;
+			unsigned int id = _guards.size();
+			_ids.emplace(e, id);
+			_guards.push_back(c);
+			byVariable[c.lhs].push_back(id);
+		}
+	}
+
+	_contradictions.resize(_guards.size());
+	for (const auto& group : byVariable) {
+		const std::vector<unsigned int>& ids = group.second;
+		for (unsigned int i = 0 ; i < ids.size() ; i++) {
+			for (unsigned int j = i + 1 ; j < ids.size() ; j++) {
+				if (contradict(_guards[ids[i]], _guards[ids[j]])) {
+					_contradictions[ids[i]].push_back(ids[j]);
+					_contradictions[ids[j]].push_back(ids[i]);
+				}
+			}
+		}
+	}
+	for (auto& c : _contradictions)
+		std::sort(c.begin(), c.end());
+
+	debug() << _guards.size() << " correlated edges found" << std::endl;
+}
+
+int CorrelatedBranches::idOf(edge e) const
+{
+	auto it = _ids.find(e);
+	return it == _ids.end() ? -1 : int(it->second);
+}
+
+bool CorrelatedBranches::contradicts(const std::vector<unsigned int>& taken, unsigned int id) const
+{
+	const std::vector<unsigned int>& contradictions = _contradictions[id];
+	if (contradictions.empty())
+		return false;
+	return std::any_of(taken.cbegin(), taken.cend(),
+		[&contradictions](unsigned int t) {
+			return std::binary_search(contradictions.cbegin(), contradictions.cend(), t);
+		});
+}
@@ -0,0 +1,89 @@
+/**
+ * @file correlated_branches.h
+ * @brief Definition of the CorrelatedBranches class
+ * @version 0.1
+ */
+#ifndef CORRELATED_BRANCHES_H
+#define CORRELATED_BRANCHES_H
+
+#include <gcc-plugin.h>
+#include <basic-block.h>
+#include <tree.h>
+
+#include <vector>
+#include <map>
+
+#include "constraint.h"
+
+/**
+ * @brief Finds the pairs of conditional edges whose guards cannot be both
+ * satisfied on a path
+ *
+ * Only the guards comparing a SSA name to a constant or to another SSA name
+ * are considered. Since a SSA name is defined only once, two such guards on
+ * the same SSA names along a path (which has no back edge) are about the same
+ * values, and their contradiction can be decided statically, without calling
+ * the solver.
+ */
+class CorrelatedBranches
+{
+	private:
+		/**
+		 * @brief The identifier assigned to each correlated edge
+		 */
+		std::map<edge,unsigned int> _ids;
+		/**
+		 * @brief The normalized guard of each correlated edge, indexed
+		 * by identifier
+		 */
+		std::vector<Constraint> _guards;
+		/**
+		 * @brief For each correlated edge, the sorted list of the
+		 * edges whose guard contradicts its own
+		 */
+		std::vector<std::vector<unsigned int>> _contradictions;
+
+		/**
+		 * @brief Normalizes a guard so that its left-hand side is a
+		 * SSA name and that, if its right-hand side is a SSA name too,
+		 * it is the one with the highest version
+		 * @param c the guard to normalize
+		 * @return true if, and only if, the guard can be correlated
+		 */
+		static bool normalize(Constraint& c);
+		/**
+		 * @brief Decides whether two normalized guards on the same
+		 * left-hand side contradict each other
+		 * @param c1 a guard
+		 * @param c2 another guard
+		 * @return true if no value of the variables satisfies both
+		 * guards
+		 */
+		static bool contradict(const Constraint& c1, const Constraint& c2);
+
+	public:
+		/**
+		 * @brief Identifies the correlated edges of the current
+		 * function and computes their contradictions
+		 */
+		void computeForCurrentFunction();
+		/**
+		 * @brief Gets the identifier of a correlated edge
+		 * @param e an edge
+		 * @return the identifier of \a e or -1 if \a e is not a
+		 * correlated edge
+		 */
+		int idOf(edge e) const;
+		/**
+		 * @brief Tells whether taking an edge contradicts one of the
+		 * correlated edges already taken on a path
+		 * @param taken the identifiers of the correlated edges taken
+		 * so far
+		 * @param id the identifier of the edge to take
+		 * @return true if, and only if, the guard of the edge \a id
+		 * is incompatible with the guard of an edge in \a taken
+		 */
+		bool contradicts(const std::vector<unsigned int>& taken, unsigned int id) const;
+};
+
+#endif /* ifndef CORRELATED_BRANCHES_H */
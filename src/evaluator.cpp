@@ -13,75 +13,462 @@
 #include <basic-block.h>
 #include <cfgloop.h>
 #include <tree-ssa-alias.h>
+#include <tree-scalar-evolution.h>
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <functional>
 #include <memory>
 #include <stack>
 #include <set>
+#include <sstream>
+#include <chrono>
+#include <mutex>
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <vector>
 
 #include <yices.h>
 
 #include "evaluator.h"
 #include "configuration.h"
 #include "loop_header_basic_block.h"
+#include "feasible_dag.h"
+#include "frontier.h"
+#include "precondition.h"
+#include "super_block.h"
 
 #include "debug.h"
 
-Evaluator::Evaluator()
+Evaluator::Evaluator(const AnalysisSettings& settings) :
+	_allbbs(std::less<basic_block>(), decltype(_allbbs)::allocator_type(&_arena)),
+	_shortcuts(std::less<RichBasicBlock*>(), decltype(_shortcuts)::allocator_type(&_arena)),
+	_graph(std::less<RichBasicBlock*>(), SubGraph::allocator_type(&_arena)),
+	_subgraphs(std::less<RichBasicBlock*>(), decltype(_subgraphs)::allocator_type(&_arena)),
+	_chains(std::less<RichBasicBlock*>(), decltype(_chains)::allocator_type(&_arena)),
+	_settings(settings)
+{
+	{
+		std::lock_guard<std::mutex> lock(Configuration::solverMutex());
+		Configuration::beginFunction();
+	}
+	try {
+		build();
+	} catch (...) {
+		// the destructor is not called, the terms of the function
+		// must be released all the same
+		unbindFromCurrentThread();
+		{
+			std::lock_guard<std::mutex> lock(Configuration::solverMutex());
+			Configuration::releaseFunctionNames();
+		}
+		Configuration::endFunction();
+		throw;
+	}
+}
+
+void Evaluator::build()
 {
-	yices_init();
 	compute_may_aliases(); //needed for the points-to oracle
+	_mayAliasSets.computeForCurrentFunction();
+	bindToCurrentThread();
 
 	debug() << "Building the rich basic blocks" << std::endl;
-	basic_block bb;
-	FOR_ALL_BB(bb) {
-		debug() << "About to build basic block " << bb->index << std::endl;
-		debug() << "is it a loop? " << std::boolalpha
-			  << bool(bb_loop_depth(bb) > 0) << std::endl;
+	scev_initialize(); //needed for the loop summaries
+	{
+		// all the terms of the function are built now, while the
+		// other functions may be walked in the background, the
+		// solver is only locked for this phase
+		std::lock_guard<std::mutex> lock(Configuration::solverMutex());
+		basic_block bb;
+		FOR_ALL_BB(bb) {
+			debug() << "About to build basic block " << bb->index << std::endl;
+			debug() << "is it a loop? " << std::boolalpha
+				  << bool(bb_loop_depth(bb) > 0) << std::endl;
 
-		RichBasicBlock* rbb =
-			(bb_loop_depth(bb) > 0 && bb->loop_father->header == bb) ?
-			buildLoopHeader(bb) :
-			_allbbs.emplace(bb, std::unique_ptr<RichBasicBlock>(new RichBasicBlock(bb)))
-				.first->second.get();
+			RichBasicBlock* rbb =
+				(bb_loop_depth(bb) > 0 && bb->loop_father->header == bb) ?
+				buildLoopHeader(bb) :
+				_allbbs.emplace(bb, std::unique_ptr<RichBasicBlock,Arena::Destroy>(
+						_arena.make<RichBasicBlock>(bb, _arena)))
+					.first->second.get();
 
-		if (rbb->hasFlowNode() && !rbb->hasLSMNode())
-			_bbsWithFlows.insert(rbb);
+			if (rbb->hasFlowNode() && !rbb->hasLSMNode())
+				_bbsWithFlows.insert(rbb);
+		}
+		Configuration::releaseFunctionNames();
 	}
+	scev_finalize();
+	_root = _allbbs.at(ENTRY_BLOCK_PTR).get();
+
+	// the dominators are released afterwards if GCC did not have them
+	bool computedDominators = !dom_info_available_p(CDI_DOMINATORS);
+	if (computedDominators)
+		calculate_dominance_info(CDI_DOMINATORS);
+	classifyFlowBlocks();
+	_correlatedBranches.computeForCurrentFunction();
+
+	// everything which depends on the CFG is computed now, so that the
+	// paths can be walked after GCC has moved on to another function
+	for (RichBasicBlock* flowBB : _bbsWithFlows) {
+		if (_shortcuts[flowBB] == Shortcut::SINGLE_PATH) {
+			std::vector<RichBasicBlock*>& chain = _chains[flowBB];
+			for (basic_block bb = flowBB->getRawBB() ;
+			     bb != ENTRY_BLOCK_PTR ;
+			     bb = single_pred(bb))
+				chain.push_back(_allbbs.at(bb).get());
+			chain.push_back(_root);
+			std::reverse(chain.begin(), chain.end());
+		} else if (_shortcuts[flowBB] == Shortcut::NONE) {
+			_graph.clear();
+			buildSubGraph(flowBB);
+			if (!cutBackEdges())
+				_truncated.insert(flowBB);
+			compactSubGraph(flowBB);
+			_subgraphs.emplace(flowBB, SubGraph(std::less<RichBasicBlock*>(),
+					SubGraph::allocator_type(&_arena)))
+				.first->second.swap(_graph);
+		}
+	}
+	if (computedDominators)
+		free_dominance_info(CDI_DOMINATORS);
+
+	// the paths may be walked in another thread
+	unbindFromCurrentThread();
 }
 
 Evaluator::~Evaluator()
 {
-	yices_exit();
+	unbindFromCurrentThread();
+	Configuration::endFunction();
+	debug() << _arena.allocated() << " bytes released from the arena" << std::endl;
+}
+
+void Evaluator::bindToCurrentThread()
+{
+	Configuration::setMayAliasSets(&_mayAliasSets);
+	Configuration::setVarTable(&_vars);
+	Configuration::setPathTree(&_pathTree);
+}
+
+void Evaluator::unbindFromCurrentThread()
+{
+	Configuration::setMayAliasSets(nullptr);
+	Configuration::setVarTable(nullptr);
+	Configuration::setPathTree(nullptr);
 }
 
 void Evaluator::evaluateAllPaths()
 {
+	bindToCurrentThread();
 	debug() << "There are " << _bbsWithFlows.size()
 		  << " bbs with flow nodes (excluding those having LSM nodes)" << std::endl;
 	for (RichBasicBlock* flowBB : _bbsWithFlows) {
 		debug() << "Examining " << *flowBB << std::endl;
-		_graph.clear();
-		buildSubGraph(flowBB);
-		debug() << "These are all the basic blocks:" << std::endl;
-		for (const auto& p : _allbbs) {
-			debug() << *(p.second) << std::endl;
-		}
-		debug() << "These are the basic blocks from the interesting "
-			     "subgraph:" << std::endl;
-		for (const auto& p : _graph) {
+		_results.emplace_back();
+		FlowBlockResult& result = _results.back();
+		result.bbIndex = flowBB->index();
+		auto start = std::chrono::steady_clock::now();
+
+		bool complete = true;
+		bool reachable = true;
+		switch (_shortcuts[flowBB]) {
+			case Shortcut::HOOK_DOMINATED:
+				debug() << "Dominated by a LSM hook" << std::endl;
+				reachable = false;
+				break;
+			case Shortcut::SINGLE_PATH:
+				debug() << "Only one path to check" << std::endl;
+				checkSinglePath(flowBB, result);
+				break;
+			case Shortcut::NONE:
+				_graph.swap(_subgraphs[flowBB]);
+				debugSubGraph();
+				reachable = _graph.count(flowBB) > 0;
+				if (_settings.mode == AnalysisSettings::SearchMode::SAMPLING) {
+					samplePaths(flowBB, result);
+					complete = !reachable; //sampling proves nothing
+				} else if (_settings.direction == AnalysisSettings::Direction::BACKWARD ||
+					   (_settings.direction == AnalysisSettings::Direction::AUTO &&
+					    preferBackward(flowBB))) {
+					complete = walkBackward(flowBB, result);
+				} else {
+					complete = walkGraph(flowBB, result);
+				}
+				// some paths were cut along with an
+				// irreducible cycle
+				if (_truncated.count(flowBB))
+					complete = false;
+				break;
+		}
+		result.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start).count();
+		debug() << _pathTree.capacity() << " path tree nodes allocated" << std::endl;
+		_pathTree.clear(); //no configuration is alive anymore
+
+		if (!_dag.empty()) {
+			std::ostringstream dot;
+			_dag.printDot(dot, "bb " + std::to_string(result.bbIndex),
+				      _settings.output == AnalysisSettings::PathOutput::COUNTED_DAG);
+			result.dag = dot.str();
+			_report << "Feasible paths to " << *flowBB << "\n"
+				<< result.dag << "\n";
+			_dag.clear();
+		}
+
+		if (result.pathsFound > 0)
+			result.verdict = FlowBlockResult::Verdict::FEASIBLE;
+		else if (!complete)
+			result.verdict = FlowBlockResult::Verdict::UNKNOWN;
+		else if (reachable)
+			result.verdict = FlowBlockResult::Verdict::INFEASIBLE;
+		else
+			result.verdict = FlowBlockResult::Verdict::UNREACHABLE;
+		flushReport();
+	}
+}
+
+void Evaluator::flushReport()
+{
+	std::string report = _report.str();
+	_report.str(std::string());
+	if (report.empty())
+		return;
+	// the workers also print the terms to stderr while holding the
+	// solver mutex, a report is written at once under the same lock
+	std::lock_guard<std::mutex> lock(Configuration::solverMutex());
+	std::cerr.write(report.data(), report.size());
+	std::cerr.flush();
+}
+
+void Evaluator::debugSubGraph()
+{
+	debug() << "These are all the basic blocks:" << std::endl;
+	for (const auto& p : _allbbs) {
+		debug() << *(p.second) << std::endl;
+	}
+	debug() << "These are the basic blocks from the interesting "
+		     "subgraph:" << std::endl;
+	for (const auto& p : _graph) {
+		debug() << '['
+			  << p.first->index()
+			  << "] (succs in graph: ";
+		for (const auto& s : p.second)
 			debug() << '['
-				  << p.first->getRawBB()->index
-				  << "] (succs in graph: ";
-			for (const auto& s : p.second)
-				debug() << '['
-					  << s->getRawBB()->index
-					  << "] ";
-			debug() << ")" << std::endl;
+				  << s->index()
+				  << "] ";
+		debug() << ")" << std::endl;
+	}
+}
+
+void Evaluator::classifyFlowBlocks()
+{
+	// For each basic block, whether it is dominated by a LSM hook (first)
+	// and whether it is reached by a single hook-free chain of
+	// blocks from the root (second)
+	std::map<basic_block,std::pair<bool,bool>> facts;
+	facts[ENTRY_BLOCK_PTR] = std::make_pair(false, true);
+
+	// walk the dominator tree, from the root
+	std::stack<basic_block> toVisit;
+	toVisit.push(ENTRY_BLOCK_PTR);
+	while (!toVisit.empty()) {
+		basic_block bb = toVisit.top();
+		toVisit.pop();
+		const std::pair<bool,bool>& idomFacts = facts[bb];
+		bool hookInIdom = _allbbs.at(bb)->hasLSMNode();
+
+		for (basic_block son = first_dom_son(CDI_DOMINATORS, bb) ;
+		     son ;
+		     son = next_dom_son(CDI_DOMINATORS, son)) {
+			// a block with a single predecessor has it as its
+			// immediate dominator
+			facts[son] = std::make_pair(
+				idomFacts.first || hookInIdom,
+				idomFacts.second && !hookInIdom && single_pred_p(son));
+			toVisit.push(son);
 		}
-		walkGraph(flowBB);
+	}
+
+	for (RichBasicBlock* flowBB : _bbsWithFlows) {
+		const std::pair<bool,bool>& f = facts[flowBB->getRawBB()];
+		_shortcuts[flowBB] = f.first ? Shortcut::HOOK_DOMINATED :
+				     f.second ? Shortcut::SINGLE_PATH :
+				     Shortcut::NONE;
+	}
+}
+
+void Evaluator::checkSinglePath(RichBasicBlock* dest, FlowBlockResult& result)
+{
+	checkPath(_chains.at(dest), result);
+}
+
+bool Evaluator::checkPath(const std::vector<RichBasicBlock*>& path, FlowBlockResult& result)
+{
+	Configuration k;
+	for (auto it = path.cbegin() ; it + 1 != path.cend() ; ++it) {
+		RichBasicBlock* rbb = *it;
+		RichBasicBlock* succ = *(it + 1);
+		rbb->applyAllConstraints(k);
+		const RichBasicBlock::Successor& s = rbb->getConstraintForSucc(*succ);
+		if (s.refuted) {
+			debug() << "The guard contradicts what GCC knows" << std::endl;
+			result.pathsRejected++;
+			result.solverCallsAvoided++;
+			return false;
+		}
+
+		int guardId = _correlatedBranches.idOf(s.e);
+		if (contradictsTakenGuards(k, guardId, succ)) {
+			debug() << "The guard contradicts a previous one" << std::endl;
+			result.pathsRejected++;
+			result.solverCallsAvoided++;
+			return false;
+		}
+
+		k.setPredecessorInfo(rbb, s.destIdx);
+		if (s.guard.term != NULL_TERM)
+			k.addConstraint(s.guard);
+		if (guardId >= 0)
+			k.addTakenGuard(guardId);
+	}
+
+	k.setPredecessorInfo(path.back(), 0);
+	result.solverCalls++;
+	if (!k) {
+		result.pathsRejected++;
+		return false;
+	}
+	reportPath(k, result);
+	return true;
+}
+
+long double Evaluator::countPaths(RichBasicBlock* rbb, RichBasicBlock* dest,
+				  std::map<RichBasicBlock*,long double>& counts)
+{
+	auto it = counts.find(rbb);
+	if (it != counts.end())
+		return it->second;
+
+	// the subgraph has no cycle, but a node in progress would close
+	// one, it counts for no path
+	counts[rbb] = 0;
+	long double n = (rbb == dest) ? 1 : 0;
+	for (RichBasicBlock* succ : _graph[rbb])
+		n += countPaths(succ, dest, counts);
+	counts[rbb] = n;
+	return n;
+}
+
+void Evaluator::samplePaths(RichBasicBlock* dest, FlowBlockResult& result)
+{
+	RichBasicBlock* root = _root;
+	std::map<RichBasicBlock*,long double> counts;
+	if (countPaths(root, dest, counts) == 0)
+		return;
+	debug() << counts[root] << " paths to sample from" << std::endl;
+
+	// the generator is seeded per flow block so that the paths drawn do
+	// not depend on the other flow blocks
+	std::mt19937_64 generator(_settings.seed + result.bbIndex);
+	unsigned int feasible = 0;
+	// the verdict of the paths already drawn: a path drawn again counts
+	// in the estimate but is neither checked nor reported again
+	std::map<std::vector<RichBasicBlock*>,bool> drawn;
+	while (result.samples < _settings.samples) {
+		if (_settings.budget > 0 && result.solverCalls >= _settings.budget)
+			break;
+
+		std::vector<RichBasicBlock*> path{root};
+		while (path.back() != dest) {
+			const std::vector<RichBasicBlock*>& succs = _graph[path.back()];
+			std::uniform_real_distribution<long double> draw(0, counts[path.back()]);
+			long double r = draw(generator);
+			// if rounding leaves r at the total, the last
+			// successor leading to the target is drawn
+			RichBasicBlock* next = nullptr;
+			for (RichBasicBlock* succ : succs) {
+				if (counts[succ] == 0)
+					continue;
+				next = succ;
+				if (r < counts[succ])
+					break;
+				r -= counts[succ];
+			}
+			assert(next);
+			path.push_back(next);
+		}
+
+		result.samples++;
+		auto it = drawn.find(path);
+		if (it == drawn.end())
+			it = drawn.emplace(path, checkPath(path, result)).first;
+		if (it->second)
+			feasible++;
+	}
+
+	if (result.samples == 0)
+		return;
+	// Wilson score interval, at 95%
+	const double z = 1.96;
+	double n = result.samples;
+	double p = double(feasible) / n;
+	double center = (p + z * z / (2 * n)) / (1 + z * z / n);
+	double halfWidth = z * std::sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / (1 + z * z / n);
+	result.feasibleFraction = p;
+	result.confidenceLow = std::max(0.0, center - halfWidth);
+	result.confidenceHigh = std::min(1.0, center + halfWidth);
+	_report << "Sampled " << result.samples << " paths (" << drawn.size()
+		<< " distinct) out of "
+		<< counts[root] << ", feasible fraction: " << p
+		<< " [" << result.confidenceLow << ", "
+		<< result.confidenceHigh << "]\n";
+}
+
+bool Evaluator::contradictsTakenGuards(const Configuration& k, int guardId,
+				       const RichBasicBlock* succ) const
+{
+	const std::vector<unsigned int>& inner = succ->innerGuards();
+	if (guardId < 0 && inner.empty())
+		return false;
+
+	std::vector<unsigned int> taken = k.takenGuards();
+	if (guardId >= 0) {
+		if (_correlatedBranches.contradicts(taken, guardId))
+			return true;
+		taken.push_back(guardId);
+	}
+	for (unsigned int id : inner) {
+		if (_correlatedBranches.contradicts(taken, id))
+			return true;
+		taken.push_back(id);
+	}
+	return false;
+}
+
+std::tuple<int,int,int> Evaluator::likelihood(const RichBasicBlock::Successor& s,
+					      const RichBasicBlock* succ)
+{
+	return std::make_tuple(s.probability, s.frequency,
+			       -int(succ->constraintCount()));
+}
+
+void Evaluator::reportPath(Configuration& k, FlowBlockResult& result)
+{
+	result.pathsFound++;
+	if (_settings.output == AnalysisSettings::PathOutput::LIST) {
+		_report << "Found a path\n\t";
+		k.printPath(_report);
+		_report << "\n";
+	} else {
+		_dag.add(k.path());
+	}
+	if (result.witnesses.size() < _settings.witnesses) {
+		std::ostringstream witness;
+		k.printPath(witness);
+		result.witnesses.push_back(witness.str());
 	}
 }
 
@@ -93,8 +480,8 @@ LoopHeaderBasicBlock* Evaluator::buildLoopHeader(basic_block bb)
 	LoopHeaderBasicBlock* lbb = static_cast<LoopHeaderBasicBlock*>(
 		_allbbs.emplace(
 			bb,
-			std::unique_ptr<RichBasicBlock>(
-				new LoopHeaderBasicBlock(bb))
+			std::unique_ptr<RichBasicBlock,Arena::Destroy>(
+				_arena.make<LoopHeaderBasicBlock>(bb, _arena))
 		).first->second.get());
 
 	debug() << "Loop added for basic_block " << bb->index << std::endl;
@@ -103,7 +490,8 @@ LoopHeaderBasicBlock* Evaluator::buildLoopHeader(basic_block bb)
 
 void Evaluator::buildSubGraph(RichBasicBlock* start)
 {
-	std::map<RichBasicBlock*,Color> colors;
+	ArenaMap<RichBasicBlock*,Color> colors{std::less<RichBasicBlock*>(),
+		ArenaMap<RichBasicBlock*,Color>::allocator_type(&_arena)};
 
 	for (const auto& rbb : _allbbs)
 		if (rbb.first == ENTRY_BLOCK_PTR)
@@ -120,10 +508,55 @@ void Evaluator::buildSubGraph(RichBasicBlock* start)
 		_graph.emplace(start,std::vector<RichBasicBlock*>());
 }
 
+bool Evaluator::cutBackEdges()
+{
+	// depth-first from the root, an edge to a node on the stack
+	// closes a cycle
+	std::map<RichBasicBlock*,Color> colors;
+	std::stack<std::pair<RichBasicBlock*,unsigned int>> stack;
+	unsigned int cut = 0;
+	unsigned int irreducible = 0;
+	colors[_root] = Color::GRAY;
+	stack.emplace(_root, 0);
+	while (!stack.empty()) {
+		RichBasicBlock* rbb = stack.top().first;
+		unsigned int& next = stack.top().second;
+		auto succs = _graph.find(rbb);
+		if (succs == _graph.end() || next >= succs->second.size()) {
+			colors[rbb] = Color::GREEN;
+			stack.pop();
+			continue;
+		}
+
+		RichBasicBlock* succ = succs->second[next];
+		Color& c = colors[succ]; //WHITE by default
+		if (c == Color::GRAY) {
+			// the edge must go for the walks to end. A back edge,
+			// whose destination dominates its source, only lies
+			// on paths going round a loop again, which the loop
+			// summaries stand for. Any other one may lie on a
+			// path visiting each block once.
+			if (!dominated_by_p(CDI_DOMINATORS, rbb->getRawBB(), succ->getRawBB()))
+				irreducible++;
+			succs->second.erase(succs->second.begin() + next);
+			cut++;
+		} else {
+			next++;
+			if (c == Color::WHITE) {
+				c = Color::GRAY;
+				stack.emplace(succ, 0);
+			}
+		}
+	}
+	debug() << cut << " edges closing a cycle cut from the subgraph, "
+		<< irreducible << " of them in irreducible cycles" << std::endl;
+	return irreducible == 0;
+}
+
 	// The resulting subgraph is the subgraph comprising the root node,
 	// the starting node and every nodes and edges belonging to paths
 	// from the root to the starting node that do not contain any RED node
-void Evaluator::dfs_visit(RichBasicBlock* bb, std::map<RichBasicBlock*,Color>& colors)
+void Evaluator::dfs_visit(RichBasicBlock* bb, ArenaMap<RichBasicBlock*,Color>& colors)
 {
 	colors[bb] = Color::GRAY;
 	bool at_least_one_pred_green = false;
@@ -157,6 +590,11 @@ void Evaluator::dfs_visit(RichBasicBlock* bb, std::map<RichBasicBlock*,Color>& c
 
 		//better to just crash at this point if p is NOT in the map
 		RichBasicBlock* p = _allbbs.at(pred).get();
+		if (p->getConstraintForSucc(*bb).refuted) {
+			debug() << "The edge from " << *p << " is infeasible, "
+				     "abandoning this path" << std::endl;
+			continue;
+		}
 
 		debug() << "got the corresponding RichBasicBlock" << std::endl;
 
@@ -188,55 +626,271 @@ void Evaluator::dfs_visit(RichBasicBlock* bb, std::map<RichBasicBlock*,Color>& c
 
 }
 
-void Evaluator::walkGraph(RichBasicBlock* dest)
+void Evaluator::compactSubGraph(RichBasicBlock* dest)
+{
+	std::map<RichBasicBlock*,std::vector<RichBasicBlock*>> preds = subGraphPredecessors();
+	// the next block of the chain of rbb, or nullptr if rbb ends its
+	// chain, the root and the target must stay nodes of their own
+	auto next = [&](RichBasicBlock* rbb) -> RichBasicBlock* {
+		if (rbb == _root || rbb == dest)
+			return nullptr;
+		auto succs = _graph.find(rbb);
+		if (succs == _graph.end() || succs->second.size() != 1)
+			return nullptr;
+		RichBasicBlock* succ = succs->second.front();
+		return (succ != dest && preds[succ].size() == 1) ? succ : nullptr;
+	};
+
+	std::map<RichBasicBlock*,RichBasicBlock*> heads;
+	std::vector<std::vector<RichBasicBlock*>> chains;
+	for (const auto& p : _graph) {
+		RichBasicBlock* rbb = p.first;
+		if (!next(rbb) || (preds[rbb].size() == 1 && next(preds[rbb].front())))
+			continue; //not the head of a chain
+
+		std::vector<RichBasicBlock*> chain{rbb};
+		for (RichBasicBlock* succ = next(rbb) ; succ ; succ = next(succ))
+			chain.push_back(succ);
+		chains.push_back(std::move(chain));
+	}
+
+	for (const std::vector<RichBasicBlock*>& chain : chains) {
+		_superblocks.emplace_back(_arena.make<SuperBlock>(chain, _correlatedBranches));
+		SuperBlock* sb = _superblocks.back().get();
+		heads[chain.front()] = sb;
+		_graph.emplace(sb, _graph[chain.back()]);
+		for (RichBasicBlock* rbb : chain)
+			_graph.erase(rbb);
+	}
+	for (auto& p : _graph)
+		for (RichBasicBlock*& succ : p.second) {
+			auto it = heads.find(succ);
+			if (it != heads.end())
+				succ = it->second;
+		}
+	debug() << chains.size() << " straight-line chains collapsed into superblocks"
+		<< std::endl;
+}
+
+bool Evaluator::walkGraph(RichBasicBlock* dest, FlowBlockResult& result)
 {
-	unsigned int pathsFound = 0;
-	unsigned int pathsRejected = 0;
+	const unsigned int& pathsFound = result.pathsFound;
+	unsigned int& pathsRejected = result.pathsRejected;
+	bool complete = true;
 	debug() << "\nStarting the walk until " << *dest << std::endl;
-	std::stack<std::pair<RichBasicBlock*,Configuration>> walk;
-	walk.emplace(_allbbs.at(ENTRY_BLOCK_PTR).get(),Configuration());
+	Frontier walk(_settings.frontier);
+	walk.push(_root,Configuration());
 	while (!walk.empty()) {
-		RichBasicBlock* rbb = walk.top().first;
+		RichBasicBlock* rbb;
+		Configuration k;
+		std::tie(rbb,k) = walk.pop();
 		debug() << "Reached " << *rbb << std::endl;
-		Configuration k = std::move(walk.top().second);
-		walk.pop();
 
 		if (rbb == dest) {
 			k.setPredecessorInfo(rbb, 0);
-			std::cerr << "Found a path\n\t";
-			pathsFound++;
-			k.printPath(std::cerr);
-			std::cerr << "\n";
+			reportPath(k, result);
+			if (_settings.mode == AnalysisSettings::SearchMode::FIRST_WITNESS)
+				break; //one path is enough
 			continue; //we can explore other branches
 		}
 
 		rbb->applyAllConstraints(k);
 		debug() << "Handled all statements" << std::endl;
 
+		// the successors worth a solver check, along with their
+		// edge and correlated edge identifier
+		typedef std::tuple<RichBasicBlock*,const RichBasicBlock::Successor*,int> Candidate;
+		std::vector<Candidate> candidates;
 		for (const auto& succ : _graph[rbb]) { //for all successors of current bb
+			if (_settings.budget > 0 &&
+			    result.solverCalls + candidates.size() >= _settings.budget) {
+				complete = false;
+				break;
+			}
 			debug() << *succ << " is a valid successor" << std::endl;
-			edge e;
-			Constraint c;
-			std::tie(e,c) = rbb->getConstraintForSucc(*succ);
+			const RichBasicBlock::Successor& s = rbb->getConstraintForSucc(*succ);
 			debug() << "extracted the constraint for successor " << *succ << std::endl;
+
+			int guardId = _correlatedBranches.idOf(s.e);
+			if (contradictsTakenGuards(k, guardId, succ)) {
+				debug() << "The guard contradicts a previous one" << std::endl;
+				pathsRejected++;
+				result.solverCallsAvoided++;
+				continue;
+			}
+
+			candidates.emplace_back(succ, &s, guardId);
+		}
+
+		// the last successor pushed is the first explored
+		if (_settings.order == AnalysisSettings::SuccessorOrder::PROBABILITY)
+			std::stable_sort(candidates.begin(), candidates.end(),
+				[](const Candidate& c1, const Candidate& c2) {
+					return likelihood(*std::get<1>(c1), std::get<0>(c1)) <
+					       likelihood(*std::get<1>(c2), std::get<0>(c2));
+				});
+		std::vector<term_t> guards;
+		for (const auto& candidate : candidates)
+			guards.push_back(std::get<1>(candidate)->guard.term);
+
+		// the prefix is shared by all the successors, it is asserted
+		// only once and the guards are checked as assumptions
+		std::vector<bool> feasible = k.checkWithGuards(guards);
+		result.solverCalls += guards.size();
+		for (unsigned int i = 0 ; i < candidates.size() ; i++) {
+			if (!feasible[i]) { //abandon the path, the resulting configuration is invalid
+				pathsRejected++;
+				continue;
+			}
+
+			RichBasicBlock* succ;
+			const RichBasicBlock::Successor* s;
+			int guardId;
+			std::tie(succ,s,guardId) = candidates[i];
 			Configuration newk{k};
 			debug() << "Configuration copied" << std::endl;
 
-			newk.setPredecessorInfo(rbb,e->dest_idx);
+			newk.setPredecessorInfo(rbb,s->destIdx);
 			debug() << "Copy of configuration initialized" << std::endl;
-			newk << c;
+			if (s->guard.term != NULL_TERM)
+				newk.addConstraint(s->guard);
+			if (guardId >= 0)
+				newk.addTakenGuard(guardId);
 			debug() << "Constraint added to configuration" << std::endl;
-			if (newk)
-				walk.emplace(succ, newk);
-			 else //abandon the path, the resulting configuration is invalid
-				pathsRejected++;
+			walk.push(succ, std::move(newk));
+		}
+		if (!complete) {
+			debug() << "Budget exhausted" << std::endl;
+			break;
+		}
+	}
+	_report << "----------------------\n"
+		<< "Result of the analysis\n"
+		<< "paths found: " << pathsFound << "\n"
+		<< "paths rejected: " << pathsRejected << "\n"
+		<< "solver calls: " << result.solverCalls << "\n"
+		<< "solver calls avoided: " << result.solverCallsAvoided << "\n"
+		<< "states spilled: " << walk.spilled() << "\n"
+		<< "----------------------\n"
+		<< std::endl;
+	return complete;
+}
+
+std::map<RichBasicBlock*,std::vector<RichBasicBlock*>> Evaluator::subGraphPredecessors() const
+{
+	std::map<RichBasicBlock*,std::vector<RichBasicBlock*>> preds;
+	for (const auto& p : _graph)
+		for (RichBasicBlock* succ : p.second)
+			preds[succ].push_back(p.first);
+	return preds;
+}
+
+long double Evaluator::countPrefixes(RichBasicBlock* rbb,
+				     const std::map<RichBasicBlock*,std::vector<RichBasicBlock*>>& preds,
+				     std::map<RichBasicBlock*,long double>& counts)
+{
+	auto it = counts.find(rbb);
+	if (it != counts.end())
+		return it->second;
+
+	// a node in progress would close a cycle, it counts for no path
+	counts[rbb] = 0;
+	long double n = (rbb == _root) ? 1 : 0;
+	auto p = preds.find(rbb);
+	if (p != preds.end())
+		for (RichBasicBlock* pred : p->second)
+			n += countPrefixes(pred, preds, counts);
+	counts[rbb] = n;
+	return n;
+}
 
+bool Evaluator::preferBackward(RichBasicBlock* dest)
+{
+	std::map<RichBasicBlock*,long double> suffixes;
+	countPaths(_root, dest, suffixes);
+	std::map<RichBasicBlock*,std::vector<RichBasicBlock*>> preds = subGraphPredecessors();
+	std::map<RichBasicBlock*,long double> prefixes;
+
+	long double forward = 0;
+	long double backward = 0;
+	for (const auto& p : _graph) {
+		for (RichBasicBlock* succ : p.second) {
+			if (p.first->getConstraintForSucc(*succ).guard.term == NULL_TERM)
+				continue;
+			forward += countPrefixes(p.first, preds, prefixes);
+			backward += countPaths(succ, dest, suffixes);
+		}
+	}
+	debug() << "Estimated guard checks, forward: " << forward
+		<< ", backward: " << backward << std::endl;
+	return backward < forward;
+}
+
+bool Evaluator::walkBackward(RichBasicBlock* dest, FlowBlockResult& result)
+{
+	std::map<RichBasicBlock*,std::vector<RichBasicBlock*>> preds = subGraphPredecessors();
+	bool complete = true;
+	debug() << "\nStarting the backward walk from " << *dest << std::endl;
+
+	// each state is a path suffix, recorded in the path tree from the
+	// target, along with its precondition
+	typedef std::tuple<RichBasicBlock*,PathTree::Ref,Precondition> State;
+	std::stack<State> walk;
+	walk.emplace(dest, _pathTree.extend(PathTree::Ref(), dest), Precondition());
+	while (!walk.empty()) {
+		RichBasicBlock* rbb;
+		PathTree::Ref suffix;
+		Precondition pre;
+		std::tie(rbb,suffix,pre) = std::move(walk.top());
+		walk.pop();
+		debug() << "Reached " << *rbb << " backward" << std::endl;
+
+		if (rbb == _root) {
+			std::vector<RichBasicBlock*> path = PathTree::materialize(suffix.get());
+			std::reverse(path.begin(), path.end());
+			if (checkPath(path, result) &&
+			    _settings.mode == AnalysisSettings::SearchMode::FIRST_WITNESS)
+				break; //one path is enough
+			continue;
+		}
+
+		for (RichBasicBlock* pred : preds[rbb]) {
+			if (_settings.budget > 0 && result.solverCalls >= _settings.budget) {
+				complete = false;
+				break;
+			}
+			const RichBasicBlock::Successor& s = pred->getConstraintForSucc(*rbb);
+			Precondition newPre{pre};
+			// the statements of the target are not part of the
+			// paths leading to it
+			if (rbb != dest)
+				rbb->applyBackward(newPre, s.destIdx);
+			newPre.add(s.guard);
+
+			// the precondition only needs a check if it has grown
+			if (newPre.size() > pre.size()) {
+				result.solverCalls++;
+				if (!newPre.satisfiable()) {
+					debug() << "No path through " << *pred
+						<< " can reach the target" << std::endl;
+					result.pathsRejected++;
+					continue;
+				}
+			}
+			walk.emplace(pred, _pathTree.extend(suffix, pred), std::move(newPre));
+		}
+		if (!complete) {
+			debug() << "Budget exhausted" << std::endl;
+			break;
 		}
 	}
-	std::cerr << "----------------------\n"
-		  << "Result of the analysis\n"
-		  << "paths found: " << pathsFound << "\n"
-		  << "paths rejected: " << pathsRejected << "\n"
-		  << "----------------------\n"
-		  << std::endl;
+	_report << "----------------------\n"
+		<< "Result of the backward analysis\n"
+		<< "paths found: " << result.pathsFound << "\n"
+		<< "paths rejected: " << result.pathsRejected << "\n"
+		<< "solver calls: " << result.solverCalls << "\n"
+		<< "solver calls avoided: " << result.solverCallsAvoided << "\n"
+		<< "----------------------\n"
+		<< std::endl;
+	return complete;
 }
@@ -14,12 +14,23 @@
 #include <set>
 #include <utility>
 #include <memory>
+#include <tuple>
+#include <sstream>
 
 #include "rich_basic_block.h"
+#include "may_alias_sets.h"
+#include "arena.h"
+#include "correlated_branches.h"
+#include "feasible_dag.h"
+#include "path_tree.h"
+#include "var_table.h"
+#include "flow_block_result.h"
+#include "analysis_settings.h"
 
 class Configuration;
 struct Constraint;
 class LoopHeaderBasicBlock;
+class SuperBlock;
 
 /**
  * @brief Main class, responsible for computing all interesting execution paths
@@ -32,14 +43,18 @@ class Evaluator {
 		 *
 		 * Initializing an Evaluator requires the following operations:
 		 * <ul>
-		 * <li>initializing Yices, the SMT solver</li>
-		 * <li>computing the aliasing information (a call to a GCC API)</li>
+		 * <li>computing the aliasing information (a call to a GCC API)
+		 * and the may-alias set of every pointer</li>
 		 * <li>building all the rich basic blocks of the current function</li>
 		 * </ul>
+		 * @param settings the parameters of the analysis
 		 */
-		Evaluator();
+		explicit Evaluator(const AnalysisSettings& settings = AnalysisSettings());
 		/**
-		 * @brief Frees the SMT solver resources
+		 * @brief Frees the SMT solver resources allocated for the
+		 * function
+		 *
+		 * The solver itself lives as long as the compilation.
 		 */
 		~Evaluator();
 		/**
@@ -65,8 +80,20 @@ class Evaluator {
 		 * </ul>
 		 */
 		void evaluateAllPaths();
+		/**
+		 * @brief Gets the results of the evaluation
+		 * @return the results for each flow basic block, available
+		 * after evaluateAllPaths() has been called
+		 */
+		const std::vector<FlowBlockResult>& results() const { return _results; }
 
 	private:
+		/**
+		 * @brief A subgraph of rich basic blocks, as the successors of
+		 * each node
+		 */
+		typedef ArenaMap<RichBasicBlock*,std::vector<RichBasicBlock*>> SubGraph;
+
 		/**
 		 * @brief The colors the basic blocks can be assigned during
 		 * the graph construction
@@ -78,6 +105,133 @@ class Evaluator {
 			RED //! Red basic blocks are basic blocks which contain LSM hook or which are unreachable from the entry basic block without passing through a basic block containing a LSM hook
 		};
 
+		/**
+		 * @brief The cases in which the paths to a flow basic block
+		 * can be decided without walking the subgraph
+		 */
+		enum class Shortcut {
+			NONE, //! The subgraph must be walked
+			HOOK_DOMINATED, //! Every path to the flow block goes through a LSM hook
+			SINGLE_PATH //! There is exactly one path to the flow block, and it is hook-free
+		};
+
+		/**
+		 * @brief Builds the rich basic blocks of the current function
+		 * and everything the walks need from the CFG
+		 *
+		 * The solver mutex is only held while the terms are built.
+		 */
+		void build();
+		/**
+		 * @brief Makes the configurations built in the current thread
+		 * use the may-alias sets, variables and path tree of this
+		 * Evaluator
+		 */
+		void bindToCurrentThread();
+		/**
+		 * @brief Makes the configurations built in the current thread
+		 * use no Evaluator at all
+		 */
+		static void unbindFromCurrentThread();
+		/**
+		 * @brief Prints the subgraph built by buildSubGraph() to the
+		 * debug sink
+		 */
+		void debugSubGraph();
+		/**
+		 * @brief Classifies all the flow basic blocks using the
+		 * dominance information, which must be available
+		 *
+		 * A flow block dominated by a block containing a LSM hook
+		 * cannot be reached without crossing the hook. A flow block
+		 * whose chain of immediate dominators, up to the root, only
+		 * consists of hook-free blocks with a single predecessor has
+		 * only one path leading to it. The results are stored in
+		 * \a _shortcuts.
+		 */
+		void classifyFlowBlocks();
+		/**
+		 * @brief Checks the only path leading to a flow basic block
+		 * classified as Shortcut::SINGLE_PATH
+		 * @param dest the flow basic block
+		 * @param result the result to fill with the outcome of the
+		 * check
+		 */
+		void checkSinglePath(RichBasicBlock* dest, FlowBlockResult& result);
+		/**
+		 * @brief Checks one path leading to a flow basic block
+		 * @param path the basic blocks of the path, from the root to
+		 * the flow basic block
+		 * @param result the result to update with the outcome of the
+		 * check
+		 * @return true if, and only if, the path is feasible
+		 */
+		bool checkPath(const std::vector<RichBasicBlock*>& path, FlowBlockResult& result);
+		/**
+		 * @brief Counts the paths going from a node of the subgraph
+		 * to the flow basic block
+		 * @param rbb a node of the subgraph built by buildSubGraph()
+		 * @param dest the flow basic block
+		 * @param counts the counts computed so far, updated with the
+		 * count of \a rbb and of its descendants
+		 * @return the number of paths from \a rbb to \a dest
+		 */
+		long double countPaths(RichBasicBlock* rbb, RichBasicBlock* dest,
+				       std::map<RichBasicBlock*,long double>& counts);
+		/**
+		 * @brief Checks paths drawn uniformly at random in the
+		 * subgraph built by buildSubGraph()
+		 *
+		 * Each successor of a node is drawn with a probability
+		 * proportional to the number of paths going through it to the
+		 * flow basic block, so that all the paths are equally likely.
+		 * The fraction of feasible paths is estimated together with
+		 * its Wilson score interval.
+		 * @param dest the flow basic block
+		 * @param result the result to fill with the outcome of the
+		 * sampling
+		 */
+		void samplePaths(RichBasicBlock* dest, FlowBlockResult& result);
+		/**
+		 * @brief Tells whether taking an edge and going through its
+		 * destination contradicts the correlated edges already taken
+		 * @param k the configuration before the edge
+		 * @param guardId the correlated identifier of the edge, or a
+		 * negative value if it is not correlated
+		 * @param succ the destination of the edge, whose inner
+		 * correlated edges are checked too
+		 * @return true if, and only if, a contradiction is found
+		 */
+		bool contradictsTakenGuards(const Configuration& k, int guardId,
+					    const RichBasicBlock* succ) const;
+		/**
+		 * @brief Estimates how likely a path going through an edge
+		 * is to be feasible
+		 *
+		 * The edges are compared by their probability, then by the
+		 * frequency of their destination and finally by the number
+		 * of constraints generated by their destination, as estimated
+		 * by GCC.
+		 * @param s an edge
+		 * @param succ the rich basic block at the destination of \a s
+		 * @return a key, the greater the likelier
+		 */
+		static std::tuple<int,int,int> likelihood(const RichBasicBlock::Successor& s,
+							  const RichBasicBlock* succ);
+		/**
+		 * @brief Reports a feasible path found to a flow basic block
+		 * @param k the configuration at the end of the path
+		 * @param result the result to update
+		 */
+		void reportPath(Configuration& k, FlowBlockResult& result);
+		/**
+		 * @brief Writes the report of the flow basic block under
+		 * analysis to the standard error, in a single write
+		 *
+		 * The reports of the functions walked by different worker
+		 * threads therefore do not interleave.
+		 */
+		void flushReport();
 		/**
 		 * @brief Builds a rich basic block representing a loop header
 		 *
@@ -108,7 +262,33 @@ class Evaluator {
 		 * @param bb the basic block to visit
 		 * @param colors the map of colors built so far
 		 */
-		void dfs_visit(RichBasicBlock* bb, std::map<RichBasicBlock*,Color>& colors);
+		void dfs_visit(RichBasicBlock* bb, ArenaMap<RichBasicBlock*,Color>& colors);
+		/**
+		 * @brief Removes from the subgraph built by buildSubGraph()
+		 * the edges closing a cycle
+		 *
+		 * dfs_visit() only cuts the latch of the innermost loop of
+		 * each block, the back edges of the outer and irreducible
+		 * loops remain. The walks and the path counts need a subgraph
+		 * without cycle. The dominance information must be available.
+		 * @return true if all the edges cut were back edges of loops,
+		 * i.e. their destination dominates their source, false if
+		 * an irreducible cycle was broken, in which case some paths
+		 * to the target may have been lost
+		 */
+		bool cutBackEdges();
+		/**
+		 * @brief Collapses the maximal straight-line chains of the
+		 * subgraph built by buildSubGraph() into superblocks
+		 *
+		 * The walks only copy the configuration and call the solver
+		 * at the nodes of the subgraph, so that inside a chain, where
+		 * there is no choice to make, the blocks are simply applied
+		 * one after the other.
+		 * @param dest the target basic block, which is never part of
+		 * a superblock
+		 */
+		void compactSubGraph(RichBasicBlock* dest);
 		/**
 		 * @brief Walks a fully built subgraph in order to decide
 		 * whether, in this graph, the paths that go from the root
@@ -117,24 +297,150 @@ class Evaluator {
 		 * This implements a depth-first visit too, but this time with
 		 * the edges in the correct direction.
 		 * @param destination the target basic block
+		 * @param result the result to fill with the outcome of the
+		 * walk
+		 * @return false if the walk was interrupted because the
+		 * budget was exhausted, true otherwise
+		 */
+		bool walkGraph(RichBasicBlock* destination, FlowBlockResult& result);
+		/**
+		 * @brief Walks a fully built subgraph backward, from a target
+		 * basic block to the root
+		 *
+		 * The precondition of each path suffix is collected and
+		 * checked as the suffix grows, so that a suffix is abandoned
+		 * as soon as no prefix can make it feasible. Each complete
+		 * path is then checked forward, since the precondition is
+		 * weaker than the constraints of the path.
+		 * @param destination the target basic block
+		 * @param result the result to fill with the outcome of the
+		 * walk
+		 * @return false if the walk was interrupted because the
+		 * budget was exhausted, true otherwise
 		 */
-		void walkGraph(RichBasicBlock* destination);
+		bool walkBackward(RichBasicBlock* destination, FlowBlockResult& result);
+		/**
+		 * @brief Computes the predecessors of the nodes of the
+		 * subgraph built by buildSubGraph()
+		 * @return the predecessors of each node in the subgraph
+		 */
+		std::map<RichBasicBlock*,std::vector<RichBasicBlock*>> subGraphPredecessors() const;
+		/**
+		 * @brief Counts the paths going from the root to a node of
+		 * the subgraph
+		 * @param rbb a node of the subgraph built by buildSubGraph()
+		 * @param preds the predecessors of the nodes of the subgraph
+		 * @param counts the counts computed so far, updated with the
+		 * count of \a rbb and of its ancestors
+		 * @return the number of paths from the root to \a rbb
+		 */
+		long double countPrefixes(RichBasicBlock* rbb,
+					  const std::map<RichBasicBlock*,std::vector<RichBasicBlock*>>& preds,
+					  std::map<RichBasicBlock*,long double>& counts);
+		/**
+		 * @brief Estimates whether walking the subgraph backward is
+		 * cheaper than walking it forward
+		 *
+		 * If no path is pruned, a forward walk checks each guard once
+		 * per path from the root to the guarded edge, and a backward
+		 * walk once per path from the guarded edge to the target.
+		 * @param dest the target basic block
+		 * @return true if, and only if, the backward walk is expected
+		 * to need fewer solver calls
+		 */
+		bool preferBackward(RichBasicBlock* dest);
 
+		/**
+		 * @brief The arena from which the rich basic blocks and the
+		 * subgraphs are allocated, released at once with the
+		 * Evaluator
+		 *
+		 * It is declared first so as to be destroyed last.
+		 */
+		Arena _arena;
 		/**
 		 * @brief The data structre where all rich basic blocks are
 		 * stored, with the correspondence with the GCC basic blocks
 		 */
-		std::map<basic_block,std::unique_ptr<RichBasicBlock>> _allbbs;
+		ArenaMap<basic_block,std::unique_ptr<RichBasicBlock,Arena::Destroy>> _allbbs;
 		/**
 		 * @brief The set of basic blocks containing a flow instruction
 		 *
 		 * For each basic block in this set, the paths must be analyzed.
 		 */
 		std::set<RichBasicBlock*> _bbsWithFlows;
+		/**
+		 * @brief The flow basic blocks whose subgraph lost some paths
+		 * when its cycles were cut
+		 *
+		 * Their verdict cannot be "infeasible".
+		 */
+		std::set<RichBasicBlock*> _truncated;
+		/**
+		 * @brief The flow basic blocks whose paths can be decided
+		 * without walking the subgraph
+		 */
+		ArenaMap<RichBasicBlock*,Shortcut> _shortcuts;
 		/**
 		 * @brief The subgraph of rich basic blocks the walkGraph method visits
 		 */
-		std::map<RichBasicBlock*,std::vector<RichBasicBlock*>> _graph;
+		SubGraph _graph;
+		/**
+		 * @brief The subgraphs of the flow basic blocks whose paths
+		 * must be walked, built along with the Evaluator
+		 */
+		ArenaMap<RichBasicBlock*,SubGraph> _subgraphs;
+		/**
+		 * @brief The only path to each flow basic block classified as
+		 * Shortcut::SINGLE_PATH, from the root
+		 */
+		ArenaMap<RichBasicBlock*,std::vector<RichBasicBlock*>> _chains;
+		/**
+		 * @brief The superblocks of all the subgraphs
+		 */
+		std::vector<std::unique_ptr<SuperBlock,Arena::Destroy>> _superblocks;
+		/**
+		 * @brief The rich basic block of the entry of the function
+		 */
+		RichBasicBlock* _root = nullptr;
+		/**
+		 * @brief The variables of the function, interned when the
+		 * rich basic blocks are built
+		 */
+		VarTable _vars;
+		/**
+		 * @brief The union of the feasible paths found to the flow
+		 * basic block under analysis, when they are reported as a DAG
+		 */
+		FeasibleDag _dag;
+		/**
+		 * @brief The report of the flow basic block under analysis,
+		 * written by flushReport() once the flow block is done
+		 */
+		std::ostringstream _report;
+		/**
+		 * @brief The may-alias sets of all the pointers of the
+		 * function, computed once and for all
+		 */
+		MayAliasSets _mayAliasSets;
+		/**
+		 * @brief The conditional edges whose guards are statically
+		 * known to contradict each other
+		 */
+		CorrelatedBranches _correlatedBranches;
+		/**
+		 * @brief The prefix tree of the paths explored for the flow
+		 * block under analysis
+		 */
+		PathTree _pathTree;
+		/**
+		 * @brief The parameters of the analysis
+		 */
+		AnalysisSettings _settings;
+		/**
+		 * @brief The results of the evaluation, one per flow block
+		 */
+		std::vector<FlowBlockResult> _results;
 };
 
 #endif /* ifndef EVALUATOR_H */
@@ -0,0 +1,45 @@
+/**
+ * @file feasible_dag.cpp
+ * @brief Implementation of the FeasibleDag class
+ * @version 0.1
+ */
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "feasible_dag.h"
+#include "rich_basic_block.h"
+
+void FeasibleDag::add(const std::vector<RichBasicBlock*>& path)
+{
+	for (auto it = path.cbegin() ; it != path.cend() ; ++it) {
+		_nodes[(*it)->index()]++;
+		if (it + 1 != path.cend())
+			_edges[std::make_pair((*it)->index(), (*(it + 1))->index())]++;
+	}
+}
+
+void FeasibleDag::clear()
+{
+	_nodes.clear();
+	_edges.clear();
+}
+
+void FeasibleDag::printDot(std::ostream& out, const std::string& name, bool withCounts) const
+{
+	out << "digraph \"" << name << "\" {\n";
+	for (const auto& n : _nodes) {
+		out << "\t" << n.first;
+		if (withCounts)
+			out << " [label=\"" << n.first << " (" << n.second << ")\"]";
+		out << ";\n";
+	}
+	for (const auto& e : _edges) {
+		out << "\t" << e.first.first << " -> " << e.first.second;
+		if (withCounts)
+			out << " [label=\"" << e.second << "\"]";
+		out << ";\n";
+	}
+	out << "}\n";
+}
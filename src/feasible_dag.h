@@ -0,0 +1,64 @@
+/**
+ * @file feasible_dag.h
+ * @brief Definition of the FeasibleDag class
+ * @version 0.1
+ */
+#ifndef FEASIBLE_DAG_H
+#define FEASIBLE_DAG_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class RichBasicBlock;
+
+/**
+ * @brief The union of the feasible paths found to a flow block
+ *
+ * Only the nodes and edges lying on at least one feasible path are kept,
+ * along with the number of feasible paths going through each of them, so
+ * the size of the DAG is linear in the size of the CFG whatever the number
+ * of paths. The nodes are identified by the index of their basic block.
+ */
+class FeasibleDag
+{
+	private:
+		/**
+		 * @brief The number of feasible paths going through each
+		 * node
+		 */
+		std::map<int,unsigned long> _nodes;
+		/**
+		 * @brief The number of feasible paths going through each
+		 * edge
+		 */
+		std::map<std::pair<int,int>,unsigned long> _edges;
+
+	public:
+		/**
+		 * @brief Adds a feasible path to the DAG
+		 * @param path the basic blocks of the path, from the root
+		 */
+		void add(const std::vector<RichBasicBlock*>& path);
+		/**
+		 * @brief Tells whether no path was added
+		 * @return true if, and only if, the DAG has no node
+		 */
+		bool empty() const { return _nodes.empty(); }
+		/**
+		 * @brief Forgets all the paths added
+		 */
+		void clear();
+		/**
+		 * @brief Outputs the DAG in the DOT language
+		 * @param out the output stream
+		 * @param name the name of the graph
+		 * @param withCounts whether the nodes and edges are labelled
+		 * with the number of feasible paths going through them
+		 */
+		void printDot(std::ostream& out, const std::string& name, bool withCounts) const;
+};
+
+#endif /* ifndef FEASIBLE_DAG_H */
@@ -0,0 +1,106 @@
+/**
+ * @file flow_block_result.h
+ * @brief Definition of the FlowBlockResult structure
+ * @version 0.1
+ */
+#ifndef FLOW_BLOCK_RESULT_H
+#define FLOW_BLOCK_RESULT_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Summarizes the outcome of the analysis of all the paths leading to
+ * one basic block containing a flow instruction
+ */
+struct FlowBlockResult {
+	/**
+	 * @brief The possible conclusions of the analysis
+	 */
+	enum class Verdict {
+		UNREACHABLE, //! Every path to the flow block goes through a LSM hook
+		INFEASIBLE, //! Hook-free paths exist in the CFG but none is feasible
+		FEASIBLE, //! At least one hook-free path is feasible
+		UNKNOWN //! The budget was exhausted before any conclusion
+	};
+
+	/**
+	 * @brief The index of the flow basic block
+	 */
+	int bbIndex = -1;
+	/**
+	 * @brief The conclusion of the analysis
+	 */
+	Verdict verdict = Verdict::UNREACHABLE;
+	/**
+	 * @brief The number of feasible paths found
+	 */
+	unsigned int pathsFound = 0;
+	/**
+	 * @brief The number of path prefixes proved unfeasible
+	 */
+	unsigned int pathsRejected = 0;
+	/**
+	 * @brief The number of satisfiability checks sent to the solver
+	 */
+	unsigned int solverCalls = 0;
+	/**
+	 * @brief The number of path prefixes rejected without calling the
+	 * solver
+	 */
+	unsigned int solverCallsAvoided = 0;
+	/**
+	 * @brief The duration of the analysis, in microseconds
+	 */
+	long long timeUs = 0;
+	/**
+	 * @brief The number of paths drawn, in sampling mode only
+	 */
+	unsigned int samples = 0;
+	/**
+	 * @brief The fraction of the paths drawn which are feasible, an
+	 * estimate of the fraction of feasible paths to the flow block
+	 */
+	double feasibleFraction = 0.0;
+	/**
+	 * @brief The lower bound of the 95% confidence interval of the
+	 * feasible fraction
+	 */
+	double confidenceLow = 0.0;
+	/**
+	 * @brief The upper bound of the 95% confidence interval of the
+	 * feasible fraction
+	 */
+	double confidenceHigh = 0.0;
+	/**
+	 * @brief Some of the feasible paths found, as printed by
+	 * Configuration::printPath()
+	 */
+	std::vector<std::string> witnesses;
+	/**
+	 * @brief The union of the feasible paths found, in the DOT language,
+	 * empty unless the paths are reported as a DAG
+	 */
+	std::string dag;
+
+	/**
+	 * @brief Gets a printable name for a verdict
+	 * @param v the verdict
+	 * @return the name of \a v
+	 */
+	static const char* verdictName(Verdict v) {
+		switch (v) {
+			case Verdict::UNREACHABLE:
+				return "unreachable";
+			case Verdict::INFEASIBLE:
+				return "infeasible";
+			case Verdict::FEASIBLE:
+				return "feasible";
+			case Verdict::UNKNOWN:
+				return "unknown";
+		}
+		return "";
+	}
+};
+
+#endif /* ifndef FLOW_BLOCK_RESULT_H */
@@ -0,0 +1,128 @@
+/**
+ * @file frontier.cpp
+ * @brief Implementation of the Frontier class
+ * @version 0.1
+ */
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "frontier.h"
+#include "configuration.h"
+#include "constraint.h"
+#include "debug.h"
+
+namespace {
+	/**
+	 * @brief Throws an exception describing a failed system call
+	 * @param what the operation which failed
+	 */
+	[[noreturn]] void fail(const std::string& what)
+	{
+		throw std::runtime_error("Frontier: " + what + ": " + std::strerror(errno));
+	}
+}
+
+Frontier::Frontier(size_t threshold) :
+	_threshold(threshold)
+{
+}
+
+Frontier::~Frontier()
+{
+	if (_fd >= 0)
+		close(_fd);
+}
+
+void Frontier::push(RichBasicBlock* rbb, Configuration&& k)
+{
+	_states.emplace_back(rbb, std::move(k));
+	if (_threshold > 0 && _states.size() > _threshold)
+		spill();
+}
+
+Frontier::State Frontier::pop()
+{
+	if (_states.empty())
+		refill();
+	State s = std::move(_states.back());
+	_states.pop_back();
+	return s;
+}
+
+void Frontier::spill()
+{
+	if (_fd < 0) {
+		const char* dir = std::getenv("TMPDIR");
+		std::string path = std::string(dir ? dir : "/tmp") + "/kayrebt_frontier_XXXXXX";
+		std::vector<char> name(path.begin(), path.end());
+		name.push_back('\0');
+		_fd = mkstemp(name.data());
+		if (_fd < 0)
+			fail("cannot create " + path);
+		// the file disappears with its descriptor
+		unlink(name.data());
+	}
+
+	size_t count = _states.size() / 2;
+	std::string buffer;
+	for (size_t i = 0 ; i < count ; i++) {
+		buffer.append(reinterpret_cast<const char*>(&_states[i].first), sizeof(RichBasicBlock*));
+		_states[i].second.serialize(buffer);
+	}
+
+	off_t offset = _runs.empty() ? 0 : _runs.back().offset + _runs.back().size;
+	size_t written = 0;
+	while (written < buffer.size()) {
+		ssize_t n = pwrite(_fd, buffer.data() + written, buffer.size() - written, offset + written);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			fail("cannot write");
+		}
+		written += n;
+	}
+	_runs.push_back(Run{offset, buffer.size(), count});
+	_states.erase(_states.begin(), _states.begin() + count);
+	_spilled += count;
+	debug() << "Spilled " << count << " states (" << buffer.size()
+		<< " bytes) to the frontier file" << std::endl;
+}
+
+void Frontier::refill()
+{
+	Run run = _runs.back();
+	_runs.pop_back();
+
+	// mmap requires an offset aligned on a page boundary
+	off_t pageSize = sysconf(_SC_PAGESIZE);
+	off_t start = run.offset - run.offset % pageSize;
+	size_t length = run.size + (run.offset - start);
+	void* map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, _fd, start);
+	if (map == MAP_FAILED)
+		fail("cannot map");
+
+	const char* in = static_cast<const char*>(map) + (run.offset - start);
+	_states.reserve(_states.size() + run.count);
+	for (size_t i = 0 ; i < run.count ; i++) {
+		RichBasicBlock* rbb;
+		std::memcpy(&rbb, in, sizeof(RichBasicBlock*));
+		in += sizeof(RichBasicBlock*);
+		_states.emplace_back(rbb, Configuration::deserialize(in));
+	}
+	munmap(map, length);
+
+	// give the space back, the next run is written at the same place
+	if (ftruncate(_fd, run.offset) < 0)
+		fail("cannot truncate");
+	debug() << "Refilled " << run.count << " states from the frontier file" << std::endl;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file frontier.h
+ * @brief Definition of the Frontier class
+ * @version 0.1
+ */
+#ifndef FRONTIER_H
+#define FRONTIER_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "configuration.h"
+
+class RichBasicBlock;
+
+/**
+ * @brief The stack of pending states of a depth-first walk, which spills its
+ * coldest states to a temporary file when it grows too large
+ *
+ * When the number of states in memory exceeds a threshold, the oldest half
+ * of them, i.e. the ones that will be popped last, are serialized as a run of
+ * compact records appended to the file. When the states in memory are
+ * exhausted, the last run written is mapped in memory, read back and removed
+ * from the file. The states are thus popped in the same order as with a plain
+ * stack.
+ */
+class Frontier
+{
+	private:
+		/**
+		 * @brief A pending state: the next basic block to visit and
+		 * the configuration reaching it
+		 */
+		typedef std::pair<RichBasicBlock*,Configuration> State;
+		/**
+		 * @brief A run of records written in the file
+		 */
+		struct Run {
+			/**
+			 * @brief The offset of the first record in the file
+			 */
+			off_t offset;
+			/**
+			 * @brief The size of the run, in bytes
+			 */
+			size_t size;
+			/**
+			 * @brief The number of states in the run
+			 */
+			size_t count;
+		};
+
+		/**
+		 * @brief The states in memory, the top of the stack is the
+		 * back of the vector
+		 */
+		std::vector<State> _states;
+		/**
+		 * @brief The runs written in the file, the last one holds the
+		 * most recent states
+		 */
+		std::vector<Run> _runs;
+		/**
+		 * @brief The maximum number of states in memory, 0 meaning
+		 * that the frontier never spills
+		 */
+		size_t _threshold;
+		/**
+		 * @brief The descriptor of the temporary file, or -1 if it
+		 * is not created yet
+		 */
+		int _fd = -1;
+		/**
+		 * @brief The number of states spilled so far
+		 */
+		size_t _spilled = 0;
+
+		/**
+		 * @brief Writes the oldest half of the states in memory to
+		 * the file
+		 */
+		void spill();
+		/**
+		 * @brief Reads back the last run written in the file
+		 */
+		void refill();
+
+	public:
+		/**
+		 * @brief Builds an empty frontier
+		 * @param threshold the maximum number of states in memory, 0
+		 * meaning no limit
+		 */
+		explicit Frontier(size_t threshold);
+		/**
+		 * @brief Closes and thus deletes the temporary file
+		 */
+		~Frontier();
+		Frontier(const Frontier&) = delete;
+		Frontier& operator=(const Frontier&) = delete;
+		/**
+		 * @brief Tells whether all the states have been popped
+		 * @return true if, and only if, there is no pending state
+		 */
+		bool empty() const { return _states.empty() && _runs.empty(); }
+		/**
+		 * @brief Pushes a state
+		 * @param rbb the next basic block to visit
+		 * @param k the configuration reaching \a rbb
+		 */
+		void push(RichBasicBlock* rbb, Configuration&& k);
+		/**
+		 * @brief Pops the most recent state
+		 * @return the state, the frontier must not be empty
+		 */
+		State pop();
+		/**
+		 * @brief Gets the number of states spilled to the file so far
+		 * @return the number of states written in the file
+		 */
+		size_t spilled() const { return _spilled; }
+};
+
+#endif /* ifndef FRONTIER_H */
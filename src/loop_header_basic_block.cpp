@@ -3,27 +3,75 @@
 #include <basic-block.h>
 #include <tree.h>
 #include <gimple.h>
+#include <cfgloop.h>
+#include <tree-flow.h>
+#include <tree-scalar-evolution.h>
 
 #include <iostream>
 
 #include "loop_header_basic_block.h"
 #include "configuration.h"
+#include "constraint.h"
 #include "debug.h"
 
-LoopHeaderBasicBlock::LoopHeaderBasicBlock(basic_block bb) : RichBasicBlock(bb)
+LoopHeaderBasicBlock::LoopHeaderBasicBlock(basic_block bb, Arena& arena) :
+	// the PHI statements of loop headers are summarized instead
+	RichBasicBlock(bb, false, arena)
 {
+	_summary.setEntryTransfer(summarizeLoop(bb), EDGE_COUNT(bb->preds));
 }
 
-void LoopHeaderBasicBlock::applyAllConstraints(Configuration& k)
+BlockSummary::Transfer LoopHeaderBasicBlock::summarizeLoop(basic_block bb)
 {
-	// we discard PHI statements in loop headers
-	for (gimple_stmt_iterator it = gsi_start_bb(_bb) ;
+	BlockSummary::Transfer t;
+	struct loop* loop = bb->loop_father;
+	// a bound on the number of executions of the latch, -1 if unknown
+	HOST_WIDE_INT iterations = max_loop_iterations_int(loop);
+
+	for (gimple_stmt_iterator it = gsi_start_phis(bb) ;
 			!gsi_end_p(it);
 			gsi_next(&it)) {
-		gimple stmt = gsi_stmt(it);
-		debug() << "Next statement : " << gimple_code_name[gimple_code(stmt)] << std::endl;
-		k << stmt;
+		gimple phi = gsi_stmt(it);
+		tree v = gimple_phi_result(phi);
+		if (!is_gimple_reg(v) || !INTEGRAL_TYPE_P(TREE_TYPE(v)))
+			continue;
+		// v is redefined when a path enters the header, whatever
+		// the edge taken
+		t.kill(v);
+
+		affine_iv iv;
+		if (!simple_iv(loop, loop, v, &iv, false) ||
+		    TREE_CODE(iv.step) != INTEGER_CST || !host_integerp(iv.step, 0))
+			continue;
+		HOST_WIDE_INT step = tree_low_cst(iv.step, 0);
+		if (step == 0) { //loop invariant
+			t.gen(Constraint(v, EQ_EXPR, iv.base));
+			_summarized++;
+			continue;
+		}
+		if (!iv.no_overflow)
+			continue;
+
+		// v = base + k * step, 0 <= k <= iterations at the header
+		t.gen(Constraint(v, step > 0 ? GE_EXPR : LE_EXPR, iv.base));
+		// the most negative step has no magnitude in HOST_WIDE_INT,
+		// negating it would overflow
+		if (iterations >= 0 && step != HOST_WIDE_INT_MIN &&
+		    iterations <= HOST_WIDE_INT_MAX / (step > 0 ? step : -step)) {
+			// the bound derived from the signedness of the IV
+			// does not fit in its type, building the delta in
+			// the type would wrap it around
+			tree delta = build_int_cst(long_long_integer_type_node, step * iterations);
+			if (int_fits_type_p(delta, TREE_TYPE(v))) {
+				delta = build_int_cst(TREE_TYPE(v), step * iterations);
+				t.gen(Constraint(v, step > 0 ? LE_EXPR : GE_EXPR, iv.base, PLUS_EXPR, delta));
+			}
+		}
+		_summarized++;
 	}
+	debug() << "Loop " << loop->num << " summarized: " << _summarized
+		<< " Phi nodes, " << t.gens.size() << " constraints" << std::endl;
+	return t;
 }
 
 void LoopHeaderBasicBlock::print(std::ostream& o) const
@@ -8,13 +8,37 @@
 
 #include <iostream>
 
+#include "block_summary.h"
 #include "rich_basic_block.h"
 
+/**
+ * @brief The rich basic block heading a loop
+ *
+ * The back edges of the loop are cut when the subgraphs are built, so the
+ * Phi nodes of the header cannot be interpreted edge by edge. They are
+ * summarized instead, once per loop: each induction variable is bounded by
+ * its initial value and, when the number of iterations is bounded, by its
+ * value at the last iteration, and each loop-invariant variable equals its
+ * initial value. The summary is applied whenever a path enters the header.
+ */
 class LoopHeaderBasicBlock : public RichBasicBlock
 {
+private:
+	/**
+	 * @brief The number of Phi nodes of the header summarized
+	 */
+	unsigned int _summarized = 0;
+	/**
+	 * @brief Computes the summary of the Phi nodes of a loop header
+	 *
+	 * The scalar evolutions must be initialized.
+	 * @param bb the loop header
+	 * @return the transfer applied when a path enters the loop
+	 */
+	BlockSummary::Transfer summarizeLoop(basic_block bb);
+
 public:
-	explicit LoopHeaderBasicBlock(basic_block bb);
-	virtual void applyAllConstraints(Configuration&) override;
+	LoopHeaderBasicBlock(basic_block bb, Arena& arena);
 	virtual void print(std::ostream& o) const override;
 };
 
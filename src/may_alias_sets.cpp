@@ -0,0 +1,122 @@
+/**
+ * @file may_alias_sets.cpp
+ * @brief Implementation of the MayAliasSets class
+ * @version 0.1
+ */
+#include <cstdlib>
+#include <gcc-plugin.h>
+#include <tree.h>
+#include <function.h>
+#include <gimple.h>
+#include <basic-block.h>
+#include <tree-flow.h>
+#include <tree-flow-inline.h>
+#include <tree-ssa-alias.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "may_alias_sets.h"
+#include "debug.h"
+
+void MayAliasSets::computeForCurrentFunction()
+{
+	_locals.clear();
+	_indices.clear();
+	_sets.clear();
+	_pointees.clear();
+
+	unsigned int ix;
+	tree var;
+	FOR_EACH_LOCAL_DECL(cfun, ix, var) {
+		if (_indices.emplace(var, _locals.size()).second)
+			_locals.push_back(var);
+	}
+	debug() << _locals.size() << " local variables indexed" << std::endl;
+
+	for (unsigned int i = 1 ; i < num_ssa_names ; i++) {
+		tree name = ssa_name(i);
+		if (!name || name == NULL_TREE || !POINTER_TYPE_P(TREE_TYPE(name)))
+			continue;
+		_sets.emplace(name, computeSet(name));
+	}
+	debug() << _sets.size() << " may-alias sets computed" << std::endl;
+
+	basic_block bb;
+	FOR_EACH_BB(bb) {
+		for (gimple_stmt_iterator it = gsi_start_bb(bb) ;
+				!gsi_end_p(it);
+				gsi_next(&it)) {
+			gimple stmt = gsi_stmt(it);
+			if (!is_gimple_assign(stmt) || !gimple_assign_single_p(stmt))
+				continue;
+			tree lhs = gimple_assign_lhs(stmt);
+			tree rhs = gimple_assign_rhs1(stmt);
+			if (!is_gimple_variable(lhs) || !POINTER_TYPE_P(TREE_TYPE(lhs)) ||
+			    TREE_CODE(rhs) != ADDR_EXPR)
+				continue;
+			std::vector<tree>& pointees = _pointees[lhs];
+			tree pointee = TREE_OPERAND(rhs, 0);
+			if (std::find(pointees.cbegin(), pointees.cend(), pointee) == pointees.cend())
+				pointees.push_back(pointee);
+		}
+	}
+}
+
+const std::vector<tree>& MayAliasSets::knownPointees(tree pointer) const
+{
+	static const std::vector<tree> none;
+	auto it = _pointees.find(pointer);
+	return it == _pointees.end() ? none : it->second;
+}
+
+LocalVarSet MayAliasSets::computeSet(tree pointer) const
+{
+	LocalVarSet res;
+
+	if (TREE_CODE(pointer) == ADDR_EXPR) {
+		// the pointee is known syntactically
+		int i = indexOf(TREE_OPERAND(pointer, 0));
+		if (i >= 0)
+			res.set(i);
+		return res;
+	}
+
+	if (TREE_CODE(pointer) != SSA_NAME) {
+		// no points-to information, fall back on the type-based
+		// alias oracle
+		for (unsigned int i = 0 ; i < _locals.size() ; i++)
+			if (alias_sets_conflict_p(get_alias_set(_locals[i]),
+						  get_deref_alias_set(pointer)))
+				res.set(i);
+		return res;
+	}
+
+	pt_solution& ptSol = get_ptr_info(pointer)->pt;
+	for (unsigned int i = 0 ; i < _locals.size() ; i++) {
+		tree var = _locals[i];
+		bool mayDeref;
+		if (ptSol.escaped || ptSol.anything)
+			mayDeref = alias_sets_conflict_p(get_alias_set(var),get_deref_alias_set(pointer));
+		else
+			mayDeref = bitmap_bit_p(ptSol.vars, DECL_PT_UID(var));
+		if (mayDeref)
+			res.set(i);
+	}
+	return res;
+}
+
+const LocalVarSet& MayAliasSets::mayAlias(tree pointer) const
+{
+	auto it = _sets.find(pointer);
+	if (it == _sets.end())
+		it = _sets.emplace(pointer, computeSet(pointer)).first;
+	return it->second;
+}
+
+int MayAliasSets::indexOf(tree var) const
+{
+	auto it = _indices.find(var);
+	return it == _indices.end() ? -1 : int(it->second);
+}
@@ -0,0 +1,196 @@
+/**
+ * @file may_alias_sets.h
+ * @brief Definition of the LocalVarSet and MayAliasSets classes
+ * @version 0.1
+ */
+#ifndef MAY_ALIAS_SETS_H
+#define MAY_ALIAS_SETS_H
+
+#include <gcc-plugin.h>
+#include <tree.h>
+
+#include <vector>
+#include <map>
+#include <limits>
+
+/**
+ * @brief A compact set of local variables, represented as a bitset over the
+ * indices assigned to the local variables of the current function by
+ * MayAliasSets
+ */
+class LocalVarSet
+{
+	public:
+		/**
+		 * @brief The type of the words the bitset is made of
+		 */
+		typedef unsigned long word_t;
+
+	private:
+		/**
+		 * @brief The number of bits in a word
+		 */
+		static constexpr unsigned int BITS = std::numeric_limits<word_t>::digits;
+		/**
+		 * @brief The bitset itself, it grows as necessary
+		 */
+		std::vector<word_t> _words;
+
+	public:
+		/**
+		 * @brief Adds a local variable to the set
+		 * @param i the index of the local variable
+		 */
+		void set(unsigned int i) {
+			if (i / BITS >= _words.size())
+				_words.resize(i / BITS + 1, 0);
+			_words[i / BITS] |= word_t(1) << (i % BITS);
+		}
+		/**
+		 * @brief Removes a local variable from the set
+		 * @param i the index of the local variable
+		 */
+		void reset(unsigned int i) {
+			if (i / BITS < _words.size())
+				_words[i / BITS] &= ~(word_t(1) << (i % BITS));
+		}
+		/**
+		 * @brief Tests whether a local variable belongs to the set
+		 * @param i the index of the local variable
+		 * @return true if, and only if, the variable is in the set
+		 */
+		bool test(unsigned int i) const {
+			return i / BITS < _words.size() &&
+			       (_words[i / BITS] & (word_t(1) << (i % BITS)));
+		}
+		/**
+		 * @brief Intersects this set with another one
+		 * @param other another set of local variables
+		 * @return this set itself
+		 */
+		LocalVarSet& operator&=(const LocalVarSet& other) {
+			if (_words.size() > other._words.size())
+				_words.resize(other._words.size());
+			for (unsigned int w = 0 ; w < _words.size() ; w++)
+				_words[w] &= other._words[w];
+			return *this;
+		}
+		/**
+		 * @brief Gets the words of the bitset, for serialization
+		 * @return the words, the bit i of the word w stands for the
+		 * local variable of index w * BITS + i
+		 */
+		const std::vector<word_t>& words() const { return _words; }
+		/**
+		 * @brief Gets the words of the bitset, for deserialization
+		 * @return the words of the bitset
+		 */
+		std::vector<word_t>& words() { return _words; }
+		/**
+		 * @brief Calls a function on each local variable of the set
+		 * @tparam F the type of the function, taking a local variable
+		 * index as parameter
+		 * @param f the function to call
+		 */
+		template<typename F>
+		void forEach(F f) const {
+			for (unsigned int w = 0 ; w < _words.size() ; w++)
+				for (word_t bits = _words[w] ; bits ; bits &= bits - 1)
+					f(w * BITS + __builtin_ctzl(bits));
+		}
+};
+
+/**
+ * @brief Intersects two sets of local variables
+ * @param s1 a set
+ * @param s2 another set
+ * @return the intersection of \a s1 and \a s2
+ */
+inline LocalVarSet operator&(LocalVarSet s1, const LocalVarSet& s2)
+{
+	return s1 &= s2;
+}
+
+/**
+ * @brief Stores, for each pointer of the current function, the set of local
+ * variables it may point to
+ *
+ * The sets are computed once per function, from the points-to information
+ * produced by GCC's compute_may_aliases(), so that a store through a pointer
+ * can be interpreted without querying the alias oracle again.
+ */
+class MayAliasSets
+{
+	private:
+		/**
+		 * @brief The local variables of the function, in the order of
+		 * their indices
+		 */
+		std::vector<tree> _locals;
+		/**
+		 * @brief The index of each local variable
+		 */
+		std::map<tree,unsigned int> _indices;
+		/**
+		 * @brief The set of local variables each pointer may point to
+		 */
+		mutable std::map<tree,LocalVarSet> _sets;
+		/**
+		 * @brief The variables whose address is assigned to each
+		 * pointer variable somewhere in the function
+		 */
+		std::map<tree,std::vector<tree>> _pointees;
+
+		/**
+		 * @brief Computes the set of local variables a pointer may
+		 * point to
+		 * @param pointer the pointer
+		 * @return the set of local variables \a pointer may point to
+		 */
+		LocalVarSet computeSet(tree pointer) const;
+
+	public:
+		/**
+		 * @brief Indexes the local variables of the current function
+		 * and computes the may-alias set of all its pointer SSA names
+		 *
+		 * The points-to information must be available, i.e.
+		 * compute_may_aliases() must have been called already.
+		 */
+		void computeForCurrentFunction();
+		/**
+		 * @brief Gets the set of local variables a pointer may point to
+		 *
+		 * Pointers which are not SSA names get their set computed and
+		 * memoized the first time they are queried.
+		 * @param pointer the pointer
+		 * @return the may-alias set of \a pointer
+		 */
+		const LocalVarSet& mayAlias(tree pointer) const;
+		/**
+		 * @brief Gets the variables whose address is assigned to a
+		 * pointer variable in the function
+		 *
+		 * These are the only variables the pointer can be known to
+		 * point to unambiguously.
+		 * @param pointer a pointer variable
+		 * @return the variables v such that an assignment
+		 * pointer = &v exists in the function
+		 */
+		const std::vector<tree>& knownPointees(tree pointer) const;
+		/**
+		 * @brief Gets the index of a local variable
+		 * @param var a variable
+		 * @return the index of \a var or -1 if \a var is not a local
+		 * variable of the function
+		 */
+		int indexOf(tree var) const;
+		/**
+		 * @brief Gets a local variable from its index
+		 * @param i the index
+		 * @return the local variable of index \a i
+		 */
+		tree local(unsigned int i) const { return _locals[i]; }
+};
+
+#endif /* ifndef MAY_ALIAS_SETS_H */
@@ -8,6 +8,16 @@
 #include <fstream>
 #include <string>
 #include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <memory>
+#include <chrono>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
 
 #include <gcc-plugin.h>
 
@@ -18,6 +28,7 @@
 #include <intl.h>
 
 #include <tm.h>
+#include <flags.h>
 #include <diagnostic.h>
 
 #include <function.h>
@@ -26,7 +37,13 @@
 
 #include <dumpfile.h>
 
+#include "analysis_queue.h"
 #include "evaluator.h"
+#include "query_capture.h"
+#include "configuration.h"
+#include "result_store.h"
+#include "target_selector.h"
+#include "analysis_settings.h"
 #include "debug.h"
 
 DebugMe DebugMe::INSTANCE;
@@ -38,6 +55,7 @@ extern "C" {
 	int plugin_is_GPL_compatible;
 	static bool evaluate_paths_gate();
 	static unsigned int evaluate_paths();
+	static void finish_plugin(void*, void*);
 
 	/**
 	 * \brief Basic information about the plugin
@@ -87,9 +105,98 @@ extern "C" {
 
 static struct plugin_name_args* functions;
 /**
- * @brief The function to analyze (-fplugin-arg-kayrebt_pathexaminer2-function=...)
+ * @brief The functions to analyze, given by
+ * -fplugin-arg-kayrebt_pathexaminer2-function=... and/or listed in the
+ * configuration file (-fplugin-arg-kayrebt_pathexaminer2-config=...)
+ */
+TargetSelector targets;
+/**
+ * @brief The settings of the function under analysis, set by the gate
+ */
+const AnalysisSettings* currentSettings = nullptr;
+/**
+ * @brief The database where the results are recorded
+ * (-fplugin-arg-kayrebt_pathexaminer2-db=...), if any
+ */
+std::unique_ptr<ResultStore> resultStore;
+/**
+ * @brief The log where the queries sent to the solver are captured
+ * (-fplugin-arg-kayrebt_pathexaminer2-capture=FILE), if any
+ *
+ * The log of each compiler process is FILE.PID, since a parallel build or
+ * the LTRANS partitions of a LTO build run many processes.
+ */
+std::unique_ptr<QueryCapture> queryCapture;
+/**
+ * @brief The number of worker threads walking the paths in the background
+ * (-fplugin-arg-kayrebt_pathexaminer2-jobs=...), 0 if the paths are walked
+ * while GCC waits
+ */
+unsigned int jobs = 0;
+/**
+ * @brief The greatest number of worker threads accepted
+ */
+const unsigned int MAX_JOBS = 256;
+/**
+ * @brief The worker threads, if \a jobs is not 0
+ */
+std::unique_ptr<AnalysisQueue> analysisQueue;
+/**
+ * @brief The results of a function analyzed in the background
  */
-const char* functionToAnalyze = nullptr;
+struct PendingFunction {
+	/**
+	 * @brief The file the function belongs to
+	 */
+	std::string file;
+	/**
+	 * @brief The name of the function
+	 */
+	std::string function;
+	/**
+	 * @brief The time spent on the function, in microseconds
+	 */
+	long long timeUs = 0;
+	/**
+	 * @brief The results of the analysis
+	 */
+	std::vector<FlowBlockResult> results;
+	/**
+	 * @brief The reason why the analysis failed, empty if it
+	 * succeeded
+	 */
+	std::string error;
+};
+/**
+ * @brief The functions analyzed in the background, in the order in which
+ * GCC compiled them
+ *
+ * The elements of a deque are never moved, so a worker can fill its element
+ * while others are pushed.
+ */
+std::deque<PendingFunction> pendingFunctions;
+
+/**
+ * \brief Parses the number of worker threads given on the command line
+ * \param value the value of the plugin argument
+ * \param[out] out the number of threads, only set if \a value is valid
+ * \return true if \a value is a decimal number between 0 and MAX_JOBS,
+ * false otherwise
+ */
+static bool parseJobs(const char* value, unsigned int& out)
+{
+	// strtoul accepts leading blanks and signs, and wraps the negative
+	// numbers around
+	if (!std::isdigit(static_cast<unsigned char>(*value)))
+		return false;
+	char* end;
+	errno = 0;
+	unsigned long n = std::strtoul(value, &end, 10);
+	if (*end != '\0' || errno == ERANGE || n > MAX_JOBS)
+		return false;
+	out = n;
+	return true;
+}
 
 /**
  * \brief Plugin entry point
@@ -108,6 +215,8 @@ extern "C" int plugin_init (struct plugin_name_args *plugin_info,
 		return -1; // incompatible
 	}
 
+	// the "optimized" pass runs in the LTRANS stage of a LTO build, the
+	// plugin must then be given to the link command too
 	struct register_pass_info actdiag_extractor_pass_info = {
 		.pass				= &path_evaluation_pass.pass,
 		.reference_pass_name		= "optimized",
@@ -118,6 +227,8 @@ extern "C" int plugin_init (struct plugin_name_args *plugin_info,
 	int argc = plugin_info->argc;
 	struct plugin_argument *argv = plugin_info->argv;
 	const char* plugin_name = plugin_info->base_name;
+	const char* configFile = nullptr;
+	std::vector<const char*> functionNames;
 
 	for (int i = 0; i < argc; ++i)
 	{
@@ -142,32 +253,244 @@ extern "C" int plugin_init (struct plugin_name_args *plugin_info,
 		if (!strcmp (argv[i].key, "function"))
 		{
 			if (argv[i].value) {
-				functionToAnalyze = argv[i].value;
+				functionNames.push_back(argv[i].value);
 			} else {
 				warning (0, G_("option '-fplugin-arg-%s-check-operator-eq'"
 							" ignored (missing arguments)"),
 						plugin_name, argv[i].value);
 			}
 		}
+		else if (!strcmp (argv[i].key, "db"))
+		{
+			if (argv[i].value) {
+				try {
+					resultStore.reset(new ResultStore(argv[i].value));
+				} catch (std::runtime_error& e) {
+					error (G_("plugin %qs: %s"), plugin_name, e.what());
+					return -1;
+				}
+			} else {
+				warning (0, G_("option '-fplugin-arg-%s-db'"
+							" ignored (missing arguments)"),
+						plugin_name);
+			}
+		}
+		else if (!strcmp (argv[i].key, "capture"))
+		{
+			if (argv[i].value) {
+				try {
+					queryCapture.reset(new QueryCapture(
+						std::string(argv[i].value) + "." + std::to_string(getpid())));
+				} catch (std::runtime_error& e) {
+					error (G_("plugin %qs: %s"), plugin_name, e.what());
+					return -1;
+				}
+			} else {
+				warning (0, G_("option '-fplugin-arg-%s-capture'"
+							" ignored (missing arguments)"),
+						plugin_name);
+			}
+		}
+		else if (!strcmp (argv[i].key, "witnesses"))
+		{
+			if (argv[i].value) {
+				targets.defaults().witnesses = std::strtoul(argv[i].value, nullptr, 10);
+			} else {
+				warning (0, G_("option '-fplugin-arg-%s-witnesses'"
+							" ignored (missing arguments)"),
+						plugin_name);
+			}
+		}
+		else if (!strcmp (argv[i].key, "budget"))
+		{
+			if (argv[i].value) {
+				targets.defaults().budget = std::strtoul(argv[i].value, nullptr, 10);
+			} else {
+				warning (0, G_("option '-fplugin-arg-%s-budget'"
+							" ignored (missing arguments)"),
+						plugin_name);
+			}
+		}
+		else if (!strcmp (argv[i].key, "frontier"))
+		{
+			if (argv[i].value) {
+				targets.defaults().frontier = std::strtoul(argv[i].value, nullptr, 10);
+			} else {
+				warning (0, G_("option '-fplugin-arg-%s-frontier'"
+							" ignored (missing arguments)"),
+						plugin_name);
+			}
+		}
+		else if (!strcmp (argv[i].key, "samples"))
+		{
+			if (argv[i].value) {
+				targets.defaults().samples = std::strtoul(argv[i].value, nullptr, 10);
+			} else {
+				warning (0, G_("option '-fplugin-arg-%s-samples'"
+							" ignored (missing arguments)"),
+						plugin_name);
+			}
+		}
+		else if (!strcmp (argv[i].key, "seed"))
+		{
+			if (argv[i].value) {
+				targets.defaults().seed = std::strtoul(argv[i].value, nullptr, 10);
+			} else {
+				warning (0, G_("option '-fplugin-arg-%s-seed'"
+							" ignored (missing arguments)"),
+						plugin_name);
+			}
+		}
+		else if (!strcmp (argv[i].key, "mode"))
+		{
+			if (!argv[i].value ||
+			    !AnalysisSettings::parseSearchMode(argv[i].value, targets.defaults().mode))
+				warning (0, G_("option '-fplugin-arg-%s-mode'"
+							" ignored (expected 'exhaustive', 'first-witness' or 'sampling')"),
+						plugin_name);
+		}
+		else if (!strcmp (argv[i].key, "order"))
+		{
+			if (!argv[i].value ||
+			    !AnalysisSettings::parseSuccessorOrder(argv[i].value, targets.defaults().order))
+				warning (0, G_("option '-fplugin-arg-%s-order'"
+							" ignored (expected 'cfg' or 'probability')"),
+						plugin_name);
+		}
+		else if (!strcmp (argv[i].key, "direction"))
+		{
+			if (!argv[i].value ||
+			    !AnalysisSettings::parseDirection(argv[i].value, targets.defaults().direction))
+				warning (0, G_("option '-fplugin-arg-%s-direction'"
+							" ignored (expected 'forward', 'backward' or 'auto')"),
+						plugin_name);
+		}
+		else if (!strcmp (argv[i].key, "output"))
+		{
+			if (!argv[i].value ||
+			    !AnalysisSettings::parsePathOutput(argv[i].value, targets.defaults().output))
+				warning (0, G_("option '-fplugin-arg-%s-output'"
+							" ignored (expected 'paths', 'dag' or 'dag-counts')"),
+						plugin_name);
+		}
+		else if (!strcmp (argv[i].key, "jobs"))
+		{
+			if (!argv[i].value || !parseJobs(argv[i].value, jobs))
+				warning (0, G_("option '-fplugin-arg-%s-jobs'"
+							" ignored (expected a number of threads"
+							" between 0 and %u)"),
+						plugin_name, MAX_JOBS);
+		}
+		else if (!strcmp (argv[i].key, "config"))
+		{
+			if (argv[i].value) {
+				configFile = argv[i].value;
+			} else {
+				warning (0, G_("option '-fplugin-arg-%s-config'"
+							" ignored (missing arguments)"),
+						plugin_name);
+			}
+		}
 		else
 			warning (0, G_("plugin %qs: unrecognized argument %qs ignored"),
 					plugin_name, argv[i].key);
 	}
 
+	if (configFile) {
+		try {
+			targets.loadFile(configFile);
+		} catch (std::runtime_error& e) {
+			error (G_("plugin %qs: %s"), plugin_name, e.what());
+			return -1;
+		}
+	}
+	// the functions given on the command line get the final defaults
+	for (const char* name : functionNames)
+		targets.addFunction(name, targets.defaults());
+
 //	fprintf(dump_file, "I'm alive!\n");
 
+	// One solver session for the whole compilation, the terms are
+	// garbage-collected after each function
+	Configuration::startSolverSession();
+	Configuration::setQueryCapture(queryCapture.get());
+	if (jobs > 0)
+		analysisQueue.reset(new AnalysisQueue(jobs));
+
 	register_callback(plugin_name,
 			PLUGIN_PASS_MANAGER_SETUP,
 			NULL,
 			&actdiag_extractor_pass_info);
+	register_callback(plugin_name,
+			PLUGIN_FINISH,
+			&finish_plugin,
+			NULL);
 	return 0;
 }
 
+/**
+ * \brief Releases the resources held by the plugin at the end of the
+ * compilation
+ */
+extern "C" void finish_plugin(void*, void*)
+{
+	if (analysisQueue) {
+		analysisQueue->join();
+		analysisQueue.reset();
+	}
+	// the results are recorded in the order of compilation, whatever
+	// the order in which the workers completed the functions
+	for (const PendingFunction& f : pendingFunctions) {
+		if (!f.error.empty()) {
+			warning (0, G_("analysis of %qs failed: %s"),
+					f.function.c_str(), f.error.c_str());
+			continue;
+		}
+		if (!resultStore)
+			continue;
+		try {
+			resultStore->record(f.file, f.function, f.timeUs, f.results);
+		} catch (std::runtime_error& e) {
+			warning (0, G_("results for %qs not recorded: %s"),
+					f.function.c_str(), e.what());
+		}
+	}
+	pendingFunctions.clear();
+
+	resultStore.reset();
+	Configuration::setQueryCapture(nullptr);
+	queryCapture.reset();
+	Configuration::endSolverSession();
+}
+
+/**
+ * \brief Gets the source file of the function under analysis
+ *
+ * In a LTRANS partition, the main input file is the partition, not the
+ * source file of the function.
+ * \return the name of the source file of the current function
+ */
+static const char* analyzedFileName()
+{
+	return in_lto_p ? DECL_SOURCE_FILE(current_function_decl) : main_input_filename;
+}
+
 extern "C" bool evaluate_paths_gate()
 {
-	return functionToAnalyze ?
-		strcmp(functionToAnalyze,current_function_name()) == 0 :
-		true;
+	currentSettings = targets.match(current_function_name());
+	// in a LTO build, the functions are analyzed once, in the LTRANS
+	// partition they end up in, and not in the compilation of each
+	// translation unit (which only happens with -ffat-lto-objects)
+	if (currentSettings && flag_generate_lto) {
+		static bool told = false;
+		if (!told)
+			inform (UNKNOWN_LOCATION, G_("the functions compiled for LTO "
+				"are analyzed at link time, the plugin must be "
+				"given to the link command too"));
+		told = true;
+		currentSettings = nullptr;
+	}
+	return currentSettings != nullptr;
 }
 
 /**
@@ -184,9 +507,47 @@ extern "C" unsigned int evaluate_paths()
 	if (errorcount || sorrycount)
 		return 0;
 
-	Evaluator ev;
+	auto start = std::chrono::steady_clock::now();
+	if (analysisQueue) {
+		// the rich CFG is built now, the paths are walked later
+		std::shared_ptr<Evaluator> ev(new Evaluator(*currentSettings));
+		long long buildUs = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start).count();
+		pendingFunctions.emplace_back();
+		PendingFunction& f = pendingFunctions.back();
+		f.file = analyzedFileName();
+		f.function = current_function_name();
+		analysisQueue->submit([ev, buildUs, &f]() mutable {
+			auto start = std::chrono::steady_clock::now();
+			try {
+				ev->evaluateAllPaths();
+				f.results = ev->results();
+			} catch (std::runtime_error& e) {
+				f.error = e.what();
+			}
+			ev.reset(); //the thread-local bindings belong to this thread
+			f.timeUs = buildUs + std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - start).count();
+		});
+		return 0;
+	}
+
+	Evaluator ev(*currentSettings);
 	ev.evaluateAllPaths();
 
+	if (resultStore) {
+		long long timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start).count();
+		try {
+			resultStore->record(analyzedFileName(),
+					    current_function_name(),
+					    timeUs, ev.results());
+		} catch (std::runtime_error& e) {
+			warning (0, G_("results for %qs not recorded: %s"),
+					current_function_name(), e.what());
+		}
+	}
+
 	return 0;
 }
 
@@ -0,0 +1,43 @@
+/**
+ * @file path_tree.cpp
+ * @brief Implementation of the PathTree class
+ * @version 0.1
+ */
+#include <algorithm>
+#include <vector>
+
+#include "path_tree.h"
+
+PathTree::Ref PathTree::extend(const Ref& parent, RichBasicBlock* bb)
+{
+	Node* node;
+	if (_free.empty()) {
+		_nodes.push_back(Node());
+		node = &_nodes.back();
+	} else {
+		node = _free.back();
+		_free.pop_back();
+	}
+	*node = Node{bb, parent._node, 0};
+	if (node->parent)
+		node->parent->refs++;
+	return Ref(this, node);
+}
+
+void PathTree::release(Node* node)
+{
+	// the ancestors are released iteratively, a path may be long
+	while (node && --node->refs == 0) {
+		_free.push_back(node);
+		node = node->parent;
+	}
+}
+
+std::vector<RichBasicBlock*> PathTree::materialize(const Node* last)
+{
+	std::vector<RichBasicBlock*> path;
+	for (const Node* n = last ; n ; n = n->parent)
+		path.push_back(n->bb);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file path_tree.h
+ * @brief Definition of the PathTree class
+ * @version 0.1
+ */
+#ifndef PATH_TREE_H
+#define PATH_TREE_H
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+class RichBasicBlock;
+
+/**
+ * @brief A prefix tree of all the path prefixes explored during a walk
+ *
+ * Each node stands for the path going from the root to it, and only stores
+ * its last basic block and its parent. The configurations forked from a
+ * common prefix thus share its history, and a path is only materialized
+ * when it must be printed. The nodes are reference-counted by the Ref
+ * handles and by their children, and a node is recycled as soon as no
+ * pending state uses it anymore, so the tree only grows with the states
+ * alive.
+ */
+class PathTree
+{
+	public:
+		/**
+		 * @brief A node of the tree, i.e. a path prefix
+		 */
+		struct Node {
+			/**
+			 * @brief The last basic block of the prefix
+			 */
+			RichBasicBlock* bb;
+			/**
+			 * @brief The prefix without its last basic block, or
+			 * nullptr if the prefix has a single basic block
+			 */
+			Node* parent;
+			/**
+			 * @brief The number of handles and children referencing
+			 * the node
+			 */
+			unsigned int refs;
+		};
+
+		/**
+		 * @brief A counted reference to a node of a tree
+		 */
+		class Ref {
+			private:
+				/**
+				 * @brief The tree of the node
+				 */
+				PathTree* _tree = nullptr;
+				/**
+				 * @brief The node referenced, or nullptr for
+				 * the empty path
+				 */
+				Node* _node = nullptr;
+
+				friend class PathTree;
+
+			public:
+				/**
+				 * @brief Builds a reference to the empty path
+				 */
+				Ref() = default;
+				/**
+				 * @brief Builds a new reference to a node
+				 * @param tree the tree of the node
+				 * @param node the node
+				 */
+				Ref(PathTree* tree, Node* node) : _tree(tree), _node(node) {
+					if (_node)
+						_node->refs++;
+				}
+				Ref(const Ref& other) : Ref(other._tree, other._node) {}
+				Ref(Ref&& other) noexcept : _tree(other._tree), _node(other._node) {
+					other._node = nullptr;
+				}
+				Ref& operator=(Ref other) {
+					std::swap(_tree, other._tree);
+					std::swap(_node, other._node);
+					return *this;
+				}
+				~Ref() noexcept {
+					if (_node)
+						_tree->release(_node);
+				}
+				/**
+				 * @brief Gets the node referenced
+				 * @return the node, or nullptr for the empty
+				 * path
+				 */
+				const Node* get() const { return _node; }
+		};
+
+	private:
+		/**
+		 * @brief The arena where the nodes are allocated, the
+		 * addresses of its elements are stable
+		 */
+		std::deque<Node> _nodes;
+		/**
+		 * @brief The nodes of the arena no longer referenced, reused
+		 * by extend()
+		 */
+		std::vector<Node*> _free;
+
+		/**
+		 * @brief Drops a reference to a node, and recycles the node
+		 * and its ancestors no longer referenced
+		 * @param node the node
+		 */
+		void release(Node* node);
+
+	public:
+		/**
+		 * @brief Extends a path prefix with one more basic block
+		 * @param parent the prefix, which may be the empty path
+		 * @param bb the basic block to append
+		 * @return the node of the new prefix
+		 */
+		Ref extend(const Ref& parent, RichBasicBlock* bb);
+		/**
+		 * @brief Gets the number of nodes in use
+		 * @return the size of the tree
+		 */
+		unsigned int size() const { return _nodes.size() - _free.size(); }
+		/**
+		 * @brief Gets the number of nodes allocated, in use or not
+		 * @return the size of the arena of the tree
+		 */
+		unsigned int capacity() const { return _nodes.size(); }
+		/**
+		 * @brief Frees all the nodes
+		 *
+		 * No reference to a node of this tree must be alive.
+		 */
+		void clear() { _nodes.clear(); _free.clear(); }
+		/**
+		 * @brief Builds the sequence of basic blocks of a path prefix
+		 * @param last the node of the prefix
+		 * @return the basic blocks of the prefix, from the root
+		 */
+		static std::vector<RichBasicBlock*> materialize(const Node* last);
+};
+
+#endif /* ifndef PATH_TREE_H */
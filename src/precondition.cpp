@@ -0,0 +1,82 @@
+/**
+ * @file precondition.cpp
+ * @brief Implementation of the Precondition class
+ * @version 0.1
+ */
+#include <cassert>
+#include <gcc-plugin.h>
+#include <tree.h>
+
+#include <vector>
+
+#include "precondition.h"
+#include "configuration.h"
+#include "may_alias_sets.h"
+#include "debug.h"
+
+void Precondition::block(VarTable::VarId id)
+{
+	if (id == VarTable::NONE) //no constraint can be about it
+		return;
+	if (_blocked.size() <= id)
+		_blocked.resize(id + 1);
+	_blocked[id] = true;
+}
+
+bool Precondition::isBlocked(const InternedConstraint& c) const
+{
+	if (_memBlocked && c.mem)
+		return true;
+	for (VarTable::VarId id : {c.lhs, c.rhs, c.rhs2})
+		if (id != VarTable::NONE && id < _blocked.size() && _blocked[id])
+			return true;
+	return false;
+}
+
+void Precondition::add(const InternedConstraint& c)
+{
+	if (c.term != NULL_TERM && !isBlocked(c))
+		_terms.push_back(c.term);
+}
+
+void Precondition::throughTransfer(const BlockSummary::Transfer& t)
+{
+	// the effects are undone in the reverse order of
+	// BlockSummary::Transfer::apply()
+	for (auto it = t.gens.crbegin() ; it != t.gens.crend() ; ++it)
+		add(it->second);
+
+	const VarTable* vars = Configuration::varTable();
+	assert(vars);
+	for (tree var : t.kills)
+		block(vars->lookup(var));
+	_memBlocked = _memBlocked || t.killMem;
+}
+
+void Precondition::throughBlock(const BlockSummary& s, unsigned int edgeTaken)
+{
+	const VarTable* vars = Configuration::varTable();
+	const MayAliasSets* sets = Configuration::mayAliasSets();
+	assert(vars && sets);
+
+	const std::vector<BlockSummary::Segment>& segments = s.segments();
+	for (auto it = segments.crbegin() ; it != segments.crend() ; ++it) {
+		if (it->pointer != NULL_TREE) {
+			it->mayAlias.forEach([this,vars,sets](unsigned int i) {
+				block(vars->lookup(sets->local(i)));
+			});
+			for (const auto& store : it->knownStores)
+				block(vars->lookup(store.first));
+		}
+		throughTransfer(it->transfer);
+	}
+
+	if (edgeTaken < s.phis().size())
+		throughTransfer(s.phis()[edgeTaken]);
+}
+
+bool Precondition::satisfiable() const
+{
+	std::vector<term_t> terms(_terms);
+	return Configuration::checkVectorOfConstraints(terms);
+}
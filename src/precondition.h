@@ -0,0 +1,97 @@
+/**
+ * @file precondition.h
+ * @brief Definition of the Precondition class
+ * @version 0.1
+ */
+#ifndef PRECONDITION_H
+#define PRECONDITION_H
+
+#include <vector>
+
+#include <yices.h>
+
+#include "block_summary.h"
+#include "var_table.h"
+
+/**
+ * @brief The constraints a path prefix must satisfy so that a given path
+ * suffix is feasible, built backward from the end of the suffix
+ *
+ * A constraint generated on the suffix only holds if the variables it is
+ * about are not killed further on the path. Going backward, the variables
+ * killed by the blocks already crossed are blocked, and the constraints
+ * generated earlier on them are discarded. The stores through pointers are
+ * interpreted as killing every variable the pointer may point to, and the
+ * pointer destinations are ignored, so the precondition is weaker than what
+ * a forward walk of the same path would collect: when it is unsatisfiable,
+ * no path ending with the suffix is feasible.
+ */
+class Precondition
+{
+	private:
+		/**
+		 * @brief The terms of the constraints collected so far
+		 */
+		std::vector<term_t> _terms;
+		/**
+		 * @brief Whether each variable, indexed by identifier, is
+		 * killed on the suffix
+		 */
+		std::vector<bool> _blocked;
+		/**
+		 * @brief Whether the variables living in memory are killed
+		 * on the suffix
+		 */
+		bool _memBlocked = false;
+
+		/**
+		 * @brief Records that a variable is killed on the suffix
+		 * @param id the identifier of the variable
+		 */
+		void block(VarTable::VarId id);
+		/**
+		 * @brief Tells whether a constraint is about a variable
+		 * killed on the suffix
+		 * @param c a constraint
+		 * @return true if, and only if, \a c would be discarded by a
+		 * forward walk before reaching the end of the suffix
+		 */
+		bool isBlocked(const InternedConstraint& c) const;
+		/**
+		 * @brief Extends the suffix backward with a transfer
+		 * @param t the transfer
+		 */
+		void throughTransfer(const BlockSummary::Transfer& t);
+
+	public:
+		/**
+		 * @brief Adds a constraint holding at the start of the suffix
+		 *
+		 * The constraint is discarded if it is about a variable killed
+		 * on the suffix, or if it cannot be interpreted.
+		 * @param c the constraint, typically the guard of the edge
+		 * preceding the suffix
+		 */
+		void add(const InternedConstraint& c);
+		/**
+		 * @brief Extends the suffix backward with a basic block
+		 * @param s the summary of the basic block
+		 * @param edgeTaken the index of the edge taken to reach the
+		 * basic block, which selects the Phi nodes to interpret
+		 */
+		void throughBlock(const BlockSummary& s, unsigned int edgeTaken);
+		/**
+		 * @brief Checks whether a path prefix can satisfy the
+		 * precondition
+		 * @return false if no path ending with the suffix is
+		 * feasible
+		 */
+		bool satisfiable() const;
+		/**
+		 * @brief Gets the number of constraints collected
+		 * @return the number of constraints in the precondition
+		 */
+		unsigned int size() const { return _terms.size(); }
+};
+
+#endif /* ifndef PRECONDITION_H */
@@ -0,0 +1,86 @@
+/**
+ * @file query_capture.cpp
+ * @brief Implementation of the QueryCapture class
+ * @version 0.1
+ */
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <yices.h>
+
+#include "query_capture.h"
+
+QueryCapture::QueryCapture(const std::string& path) :
+	_out(path, std::ios::out | std::ios::trunc)
+{
+	if (!_out)
+		throw std::runtime_error("Cannot open the query log " + path);
+	_out << "(set-option :print-success false)\n"
+	     << "(set-option :global-declarations true)\n"
+	     << "(set-logic QF_LIA)\n";
+}
+
+void QueryCapture::declare(term_t t, const std::string& name)
+{
+	std::string unique = "|" + name + "!" + std::to_string(_vars++) + "|";
+	_out << "(declare-fun " << unique << " () Int)\n";
+	_texts[t] = unique;
+}
+
+void QueryCapture::define(term_t t, const std::string& text)
+{
+	_texts[t] = text;
+}
+
+const std::string& QueryCapture::text(term_t t) const
+{
+	static const std::string unknown = "true";
+	auto it = _texts.find(t);
+	return it == _texts.end() ? unknown : it->second;
+}
+
+void QueryCapture::pop(unsigned int n)
+{
+	if (n == 0)
+		return;
+	_out << "(pop " << n << ")\n";
+	_asserted.resize(_asserted.size() - n);
+}
+
+void QueryCapture::assertAll(const std::vector<term_t>& terms)
+{
+	unsigned int shared = 0;
+	while (shared < _asserted.size() && shared < terms.size() &&
+	       _asserted[shared] == terms[shared])
+		shared++;
+
+	pop(_asserted.size() - shared);
+	for (unsigned int i = shared ; i < terms.size() ; i++) {
+		_out << "(push 1)\n(assert " << text(terms[i]) << ")\n";
+		_asserted.push_back(terms[i]);
+	}
+}
+
+void QueryCapture::check(term_t assumption, smt_status_t status, long long timeUs)
+{
+	// check-sat-assuming only accepts literals, the assumption gets a
+	// level of its own instead
+	if (assumption == NULL_TERM)
+		_out << "(check-sat)\n";
+	else
+		_out << "(push 1)\n(assert " << text(assumption) << ")\n"
+		     << "(check-sat)\n(pop 1)\n";
+
+	const char* verdict = status == STATUS_SAT ? "sat" :
+			      status == STATUS_UNSAT ? "unsat" : "unknown";
+	_out << "; result: " << verdict << " time_us: " << timeUs << "\n";
+}
+
+void QueryCapture::forgetTerms()
+{
+	pop(_asserted.size());
+	_texts.clear();
+	_out.flush();
+}
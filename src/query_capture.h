@@ -0,0 +1,111 @@
+/**
+ * @file query_capture.h
+ * @brief Definition of the QueryCapture class
+ * @version 0.1
+ */
+#ifndef QUERY_CAPTURE_H
+#define QUERY_CAPTURE_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <yices.h>
+
+/**
+ * @brief A log of the satisfiability checks sent to the solver, written as
+ * an incremental SMT-LIB2 script
+ *
+ * Each constraint asserted lives in its own assertion level, so that a query
+ * is written as a delta from the previous one: the levels of the constraints
+ * the two queries do not share are popped, and the new constraints are
+ * pushed. Each check is followed by a comment giving the verdict of Yices
+ * and the time it took, in the form "; result: sat time_us: 42", which the
+ * replay tool compares with its own. The checks under an assumption push
+ * the assumption in a level of its own, popped right after the check.
+ *
+ * The terms are rendered as SMT-LIB2 when they are built, the capture does
+ * not need to inspect Yices terms. The variables get a name unique in the
+ * whole log, since the names of the terms are reused from one function to
+ * another.
+ */
+class QueryCapture
+{
+	private:
+		/**
+		 * @brief The log file
+		 */
+		std::ofstream _out;
+		/**
+		 * @brief The SMT-LIB2 rendering of the terms built so far
+		 */
+		std::map<term_t,std::string> _texts;
+		/**
+		 * @brief The constraints asserted, one per assertion level
+		 */
+		std::vector<term_t> _asserted;
+		/**
+		 * @brief The number of variables declared so far
+		 */
+		unsigned long _vars = 0;
+
+		/**
+		 * @brief Pops assertion levels
+		 * @param n the number of levels to pop
+		 */
+		void pop(unsigned int n);
+
+	public:
+		/**
+		 * @brief Opens a log file and writes its prelude
+		 * @param path the path of the log file, which is truncated
+		 * @throw std::runtime_error if the file cannot be opened
+		 */
+		explicit QueryCapture(const std::string& path);
+		/**
+		 * @brief Declares a new integer variable
+		 * @param t the uninterpreted term of the variable
+		 * @param name the name of the variable in the plugin, used as
+		 * a prefix of its name in the log
+		 */
+		void declare(term_t t, const std::string& name);
+		/**
+		 * @brief Records the SMT-LIB2 rendering of a term
+		 * @param t the term
+		 * @param text the rendering of \a t
+		 */
+		void define(term_t t, const std::string& text);
+		/**
+		 * @brief Gets the SMT-LIB2 rendering of a term
+		 * @param t a term
+		 * @return the rendering recorded for \a t, or "true" if the
+		 * term is unknown to the capture, so that the log remains
+		 * well-formed
+		 */
+		const std::string& text(term_t t) const;
+		/**
+		 * @brief Writes the assertions of a query, as a delta from the
+		 * assertions of the previous one
+		 * @param terms the constraints of the query
+		 */
+		void assertAll(const std::vector<term_t>& terms);
+		/**
+		 * @brief Writes a check of the constraints asserted
+		 * @param assumption a term assumed for this check only, or
+		 * NULL_TERM
+		 * @param status the verdict of Yices
+		 * @param timeUs the time taken by Yices, in microseconds
+		 */
+		void check(term_t assumption, smt_status_t status, long long timeUs);
+		/**
+		 * @brief Forgets all the terms, which must be done when Yices
+		 * garbage-collects them
+		 *
+		 * All the assertion levels are popped, the variables already
+		 * declared remain declared under their unique names.
+		 */
+		void forgetTerms();
+};
+
+#endif /* ifndef QUERY_CAPTURE_H */
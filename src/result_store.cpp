@@ -0,0 +1,248 @@
+/**
+ * @file result_store.cpp
+ * @brief Implementation of the ResultStore class
+ * @version 0.1
+ */
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include <sqlite3.h>
+
+#include "result_store.h"
+#include "flow_block_result.h"
+#include "debug.h"
+
+ResultStore::ResultStore(const std::string& path, unsigned int batchSize) :
+	_batchSize(batchSize)
+{
+	if (sqlite3_open_v2(path.c_str(), &_db,
+			    SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+			    nullptr) != SQLITE_OK) {
+		std::string msg = _db ? sqlite3_errmsg(_db) : "out of memory";
+		sqlite3_close(_db);
+		throw std::runtime_error("Cannot open " + path + ": " + msg);
+	}
+
+	try {
+		init();
+	} catch (...) {
+		sqlite3_finalize(_insertFunction);
+		sqlite3_finalize(_insertFlowBlock);
+		sqlite3_finalize(_insertWitness);
+		sqlite3_close(_db);
+		throw;
+	}
+}
+
+void ResultStore::init()
+{
+	// hundreds of compilers may write concurrently, wait for the lock
+	// rather than failing
+	sqlite3_busy_timeout(_db, 10 * 60 * 1000);
+	exec("PRAGMA journal_mode=WAL");
+	exec("PRAGMA synchronous=NORMAL");
+
+	exec("BEGIN IMMEDIATE");
+	int version = schemaVersion();
+	if (version > SCHEMA_VERSION)
+		throw std::runtime_error("The result database has schema version " +
+					 std::to_string(version) + ", newer than " +
+					 std::to_string(SCHEMA_VERSION));
+	exec("CREATE TABLE IF NOT EXISTS functions ("
+	     "id INTEGER PRIMARY KEY, "
+	     "file TEXT NOT NULL, "
+	     "function TEXT NOT NULL, "
+	     "flow_blocks INTEGER NOT NULL, "
+	     "time_us INTEGER NOT NULL)");
+	exec("CREATE TABLE IF NOT EXISTS flow_blocks ("
+	     "function_id INTEGER NOT NULL REFERENCES functions(id), "
+	     "bb INTEGER NOT NULL, "
+	     "verdict TEXT NOT NULL, "
+	     "paths_found INTEGER NOT NULL, "
+	     "paths_rejected INTEGER NOT NULL, "
+	     "solver_calls INTEGER NOT NULL, "
+	     "solver_calls_avoided INTEGER NOT NULL, "
+	     "time_us INTEGER NOT NULL, "
+	     "samples INTEGER, "
+	     "feasible_fraction REAL, "
+	     "confidence_low REAL, "
+	     "confidence_high REAL, "
+	     "dag TEXT)");
+	exec("CREATE TABLE IF NOT EXISTS witnesses ("
+	     "function_id INTEGER NOT NULL REFERENCES functions(id), "
+	     "bb INTEGER NOT NULL, "
+	     "path TEXT NOT NULL)");
+	if (version < SCHEMA_VERSION) {
+		migrate();
+		exec(("PRAGMA user_version = " + std::to_string(SCHEMA_VERSION)).c_str());
+	}
+	exec("COMMIT");
+
+	if (sqlite3_prepare_v2(_db,
+			"INSERT INTO functions (file, function, flow_blocks, time_us) "
+			"VALUES (?1, ?2, ?3, ?4)", -1, &_insertFunction, nullptr) != SQLITE_OK ||
+	    sqlite3_prepare_v2(_db,
+			"INSERT INTO flow_blocks (function_id, bb, verdict, paths_found, "
+			"paths_rejected, solver_calls, solver_calls_avoided, time_us, "
+			"samples, feasible_fraction, confidence_low, confidence_high, dag) "
+			"VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13)",
+			-1, &_insertFlowBlock, nullptr) != SQLITE_OK ||
+	    sqlite3_prepare_v2(_db,
+			"INSERT INTO witnesses (function_id, bb, path) VALUES (?1, ?2, ?3)",
+			-1, &_insertWitness, nullptr) != SQLITE_OK)
+		fail("Cannot prepare statements");
+}
+
+int ResultStore::schemaVersion()
+{
+	sqlite3_stmt* stmt;
+	if (sqlite3_prepare_v2(_db, "PRAGMA user_version", -1, &stmt, nullptr) != SQLITE_OK)
+		fail("Cannot read the schema version");
+	int version = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+	sqlite3_finalize(stmt);
+	return version;
+}
+
+void ResultStore::migrate()
+{
+	// the columns added to flow_blocks since the first version, only
+	// those the table lacks are added
+	static const std::vector<std::pair<const char*,const char*>> added{
+		{"solver_calls",         "INTEGER NOT NULL DEFAULT 0"},
+		{"solver_calls_avoided", "INTEGER NOT NULL DEFAULT 0"},
+		{"samples",              "INTEGER"},
+		{"feasible_fraction",    "REAL"},
+		{"confidence_low",       "REAL"},
+		{"confidence_high",      "REAL"},
+		{"dag",                  "TEXT"}
+	};
+
+	sqlite3_stmt* stmt;
+	if (sqlite3_prepare_v2(_db, "PRAGMA table_info(flow_blocks)", -1, &stmt, nullptr) != SQLITE_OK)
+		fail("Cannot read the columns of flow_blocks");
+	std::set<std::string> columns;
+	while (sqlite3_step(stmt) == SQLITE_ROW)
+		columns.insert(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+	sqlite3_finalize(stmt);
+
+	for (const auto& c : added) {
+		if (columns.count(c.first))
+			continue;
+		debug() << "Adding the column " << c.first << " to flow_blocks" << std::endl;
+		exec((std::string("ALTER TABLE flow_blocks ADD COLUMN ") +
+		      c.first + " " + c.second).c_str());
+	}
+}
+
+ResultStore::~ResultStore()
+{
+	try {
+		flush();
+	} catch (std::exception& e) {
+		std::cerr << "Results lost: " << e.what() << std::endl;
+	}
+	sqlite3_finalize(_insertFunction);
+	sqlite3_finalize(_insertFlowBlock);
+	sqlite3_finalize(_insertWitness);
+	sqlite3_close(_db);
+}
+
+void ResultStore::exec(const char* sql)
+{
+	if (sqlite3_exec(_db, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
+		fail(std::string("Cannot execute ") + sql);
+}
+
+void ResultStore::fail(const std::string& what)
+{
+	throw std::runtime_error(what + ": " + sqlite3_errmsg(_db));
+}
+
+void ResultStore::step(sqlite3_stmt* stmt)
+{
+	int code = sqlite3_step(stmt);
+	sqlite3_reset(stmt);
+	if (code != SQLITE_DONE)
+		fail("Cannot insert results");
+}
+
+void ResultStore::record(const std::string& file, const std::string& function,
+			 long long timeUs, const std::vector<FlowBlockResult>& results)
+{
+	_pending.push_back(FunctionRecord{file, function, timeUs, results});
+	_pendingRows++;
+	for (const FlowBlockResult& r : results)
+		_pendingRows += 1 + r.witnesses.size();
+
+	if (_pendingRows >= _batchSize)
+		flush();
+}
+
+void ResultStore::flush()
+{
+	if (_pending.empty())
+		return;
+
+	debug() << "Writing " << _pendingRows << " rows of results" << std::endl;
+	// take the write lock at once, so that the transaction never has to
+	// be upgraded (which the busy timeout cannot resolve)
+	exec("BEGIN IMMEDIATE");
+	try {
+		writePending();
+	} catch (...) {
+		sqlite3_exec(_db, "ROLLBACK", nullptr, nullptr, nullptr);
+		throw;
+	}
+	exec("COMMIT");
+
+	_pending.clear();
+	_pendingRows = 0;
+}
+
+void ResultStore::writePending()
+{
+	for (const FunctionRecord& f : _pending) {
+		sqlite3_bind_text(_insertFunction, 1, f.file.c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_text(_insertFunction, 2, f.function.c_str(), -1, SQLITE_STATIC);
+		sqlite3_bind_int(_insertFunction, 3, f.results.size());
+		sqlite3_bind_int64(_insertFunction, 4, f.timeUs);
+		step(_insertFunction);
+		sqlite3_int64 id = sqlite3_last_insert_rowid(_db);
+
+		for (const FlowBlockResult& r : f.results) {
+			sqlite3_bind_int64(_insertFlowBlock, 1, id);
+			sqlite3_bind_int(_insertFlowBlock, 2, r.bbIndex);
+			sqlite3_bind_text(_insertFlowBlock, 3,
+					  FlowBlockResult::verdictName(r.verdict), -1, SQLITE_STATIC);
+			sqlite3_bind_int64(_insertFlowBlock, 4, r.pathsFound);
+			sqlite3_bind_int64(_insertFlowBlock, 5, r.pathsRejected);
+			sqlite3_bind_int64(_insertFlowBlock, 6, r.solverCalls);
+			sqlite3_bind_int64(_insertFlowBlock, 7, r.solverCallsAvoided);
+			sqlite3_bind_int64(_insertFlowBlock, 8, r.timeUs);
+			if (r.samples > 0) {
+				sqlite3_bind_int64(_insertFlowBlock, 9, r.samples);
+				sqlite3_bind_double(_insertFlowBlock, 10, r.feasibleFraction);
+				sqlite3_bind_double(_insertFlowBlock, 11, r.confidenceLow);
+				sqlite3_bind_double(_insertFlowBlock, 12, r.confidenceHigh);
+			} else {
+				for (int i = 9 ; i <= 12 ; i++)
+					sqlite3_bind_null(_insertFlowBlock, i);
+			}
+			if (!r.dag.empty())
+				sqlite3_bind_text(_insertFlowBlock, 13, r.dag.c_str(), -1, SQLITE_STATIC);
+			else
+				sqlite3_bind_null(_insertFlowBlock, 13);
+			step(_insertFlowBlock);
+
+			for (const std::string& w : r.witnesses) {
+				sqlite3_bind_int64(_insertWitness, 1, id);
+				sqlite3_bind_int(_insertWitness, 2, r.bbIndex);
+				sqlite3_bind_text(_insertWitness, 3, w.c_str(), -1, SQLITE_STATIC);
+				step(_insertWitness);
+			}
+		}
+	}
+}
@@ -0,0 +1,151 @@
+/**
+ * @file result_store.h
+ * @brief Definition of the ResultStore class
+ * @version 0.1
+ */
+#ifndef RESULT_STORE_H
+#define RESULT_STORE_H
+
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "flow_block_result.h"
+
+/**
+ * @brief Records the results of the analysis in a SQLite database
+ *
+ * The database may be shared by many concurrent compilations (e.g. a
+ * parallel build of the kernel). To keep the lock contention low, the
+ * database is opened in WAL mode and the results are buffered in memory
+ * and written in large batches, each batch in a single short transaction.
+ */
+class ResultStore
+{
+	private:
+		/**
+		 * @brief The results of a function, waiting to be written
+		 */
+		struct FunctionRecord {
+			std::string file;
+			std::string function;
+			long long timeUs;
+			std::vector<FlowBlockResult> results;
+		};
+
+		/**
+		 * @brief The database connection
+		 */
+		sqlite3* _db = nullptr;
+		/**
+		 * @brief The statement inserting a function
+		 */
+		sqlite3_stmt* _insertFunction = nullptr;
+		/**
+		 * @brief The statement inserting a flow block
+		 */
+		sqlite3_stmt* _insertFlowBlock = nullptr;
+		/**
+		 * @brief The statement inserting a witness path
+		 */
+		sqlite3_stmt* _insertWitness = nullptr;
+		/**
+		 * @brief The results not yet written to the database
+		 */
+		std::vector<FunctionRecord> _pending;
+		/**
+		 * @brief The number of rows buffered in \a _pending
+		 */
+		unsigned int _pendingRows = 0;
+		/**
+		 * @brief The number of rows beyond which the pending results
+		 * are written
+		 */
+		unsigned int _batchSize;
+
+		/**
+		 * @brief The version of the schema, stored in the
+		 * user_version of the database
+		 */
+		static const int SCHEMA_VERSION = 4;
+
+		/**
+		 * @brief Sets up the database connection and creates the
+		 * tables if they do not exist yet
+		 *
+		 * The tables created by the previous versions are migrated.
+		 * @throw std::runtime_error if the database was created by a
+		 * newer version
+		 */
+		void init();
+		/**
+		 * @brief Adds to the flow_blocks table of a database created
+		 * by a previous version the columns it lacks
+		 */
+		void migrate();
+		/**
+		 * @brief Gets the version of the schema of the database
+		 * @return the user_version of the database, 0 for a new
+		 * database
+		 */
+		int schemaVersion();
+		/**
+		 * @brief Inserts all the pending results, inside an already
+		 * open transaction
+		 */
+		void writePending();
+		/**
+		 * @brief Executes a SQL statement without results
+		 * @param sql the statement
+		 */
+		void exec(const char* sql);
+		/**
+		 * @brief Throws an exception describing the last SQLite error
+		 * @param what the operation that failed
+		 */
+		[[noreturn]] void fail(const std::string& what);
+		/**
+		 * @brief Executes a prepared statement and resets it
+		 * @param stmt the prepared statement, with all parameters
+		 * bound
+		 */
+		void step(sqlite3_stmt* stmt);
+
+	public:
+		/**
+		 * @brief Opens (and creates if necessary) a result database
+		 * @param path the path of the database file
+		 * @param batchSize the number of rows to buffer before writing
+		 * them
+		 * @throw std::runtime_error if the database cannot be opened
+		 */
+		explicit ResultStore(const std::string& path, unsigned int batchSize = 4096);
+		/**
+		 * @brief Writes the pending results and closes the database
+		 */
+		~ResultStore();
+		ResultStore(const ResultStore&) = delete;
+		ResultStore& operator=(const ResultStore&) = delete;
+		/**
+		 * @brief Records the results of the analysis of a function
+		 *
+		 * The results may be buffered, they are only guaranteed to be
+		 * written after a call to flush() or the destruction of the
+		 * store.
+		 * @param file the source file the function comes from
+		 * @param function the name of the function
+		 * @param timeUs the duration of the analysis of the whole
+		 * function, in microseconds
+		 * @param results the results for each flow block
+		 */
+		void record(const std::string& file, const std::string& function,
+			    long long timeUs, const std::vector<FlowBlockResult>& results);
+		/**
+		 * @brief Writes all the pending results in one transaction
+		 * @throw std::runtime_error if the results cannot be written
+		 */
+		void flush();
+};
+
+#endif /* ifndef RESULT_STORE_H */
@@ -16,10 +16,18 @@
 
 #include "rich_basic_block.h"
 #include "configuration.h"
+#include "precondition.h"
 #include "debug.h"
 
-RichBasicBlock::RichBasicBlock(basic_block bb) :
+RichBasicBlock::RichBasicBlock(basic_block bb, Arena& arena) :
+	RichBasicBlock(bb, true, arena)
+{
+}
+
+RichBasicBlock::RichBasicBlock(basic_block bb, bool withPhis, Arena& arena) :
 	_bb(bb),
+	_index(bb->index),
+	_succs(std::less<basic_block>(), decltype(_succs)::allocator_type(&arena)),
 	_hasFlow(false),
 	_hasLSM(false)
 {
@@ -36,10 +44,43 @@ RichBasicBlock::RichBasicBlock(basic_block bb) :
 			<< std::endl;
 	}
 
+	_summary = BlockSummary(bb, withPhis);
+
 	edge succ;
 	edge_iterator succ_it;
-	FOR_EACH_EDGE(succ, succ_it, _bb->succs)
-		_succs.emplace(succ->dest, std::forward_as_tuple(succ, Constraint(succ)));
+	FOR_EACH_EDGE(succ, succ_it, _bb->succs) {
+		// the guard is interpreted once, it is then reused each time
+		// a path goes through the edge
+		Constraint c(succ);
+		InternedConstraint guard;
+		bool refuted = false;
+		if (Configuration::acceptConstraint(c)) {
+			refuted = Configuration::contradictsType(c);
+			term_t t = Configuration::buildTerm(c);
+			// what GCC knows about the operands is carried along
+			// with the guard
+			term_t facts = Configuration::buildKnownFacts(c);
+			if (facts != NULL_TERM)
+				t = Configuration::conjoin(t, facts);
+			guard = Configuration::intern(c, t);
+		}
+		if (refuted)
+			debug() << "The edge to " << succ->dest->index
+				<< " contradicts what GCC knows" << std::endl;
+		_succs.emplace(succ->dest, Successor{succ, succ->dest_idx,
+			succ->probability, succ->dest->frequency, guard, refuted});
+		_succIndices.push_back(succ->dest->index);
+	}
+}
+
+RichBasicBlock::RichBasicBlock(const RichBasicBlock& entry, const RichBasicBlock& exit) :
+	_bb(entry._bb),
+	_index(exit._index),
+	_succs(exit._succs),
+	_succIndices(exit._succIndices),
+	_hasFlow(false),
+	_hasLSM(false)
+{
 }
 
 std::tuple<bool,bool> RichBasicBlock::isLSMorFlowBB(basic_block bb)
@@ -72,7 +113,7 @@ std::tuple<bool,bool> RichBasicBlock::isLSMorFlowBB(basic_block bb)
 	return std::make_tuple(isLSM, isFlow);
 }
 
-std::tuple<const edge,const Constraint&> RichBasicBlock::getConstraintForSucc(const RichBasicBlock& succ) const
+const RichBasicBlock::Successor& RichBasicBlock::getConstraintForSucc(const RichBasicBlock& succ) const
 {
 	return _succs.at(succ.getRawBB()); //throws an error if bb is not found
 					   //it should NEVER be the case
@@ -86,29 +127,19 @@ std::ostream& operator<<(std::ostream& o, const RichBasicBlock& rbb)
 
 void RichBasicBlock::print(std::ostream& o) const
 {
-	o << '<' << _bb->index << '>';
+	o << '<' << _index << '>';
 	o << " (succs: ";
-	edge elt;
-	edge_iterator it;
-	FOR_EACH_EDGE(elt, it, _bb->succs) {
-		o << elt->dest->index << " ";
-	}
+	for (int i : _succIndices)
+		o << i << " ";
 	o << ")";
 }
 
 void RichBasicBlock::applyAllConstraints(Configuration& k)
 {
-	for (gimple_stmt_iterator it = gsi_start_phis(_bb) ;
-			!gsi_end_p(it);
-			gsi_next(&it)) {
-		gimple stmt = gsi_stmt(it);
-		k << stmt;
-	}
-	for (gimple_stmt_iterator it = gsi_start_bb(_bb) ;
-			!gsi_end_p(it);
-			gsi_next(&it)) {
-		gimple stmt = gsi_stmt(it);
-		debug() << "Next statement : " << gimple_code_name[gimple_code(stmt)] << std::endl;
-		k << stmt;
-	}
+	_summary.apply(k);
+}
+
+void RichBasicBlock::applyBackward(Precondition& pre, unsigned int edgeTaken) const
+{
+	pre.throughBlock(_summary, edgeTaken);
 }
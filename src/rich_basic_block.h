@@ -16,25 +16,80 @@
 #include <iostream>
 #include <tuple>
 #include <map>
+#include <vector>
 
+#include <yices.h>
+
+#include "arena.h"
 #include "constraint.h"
+#include "block_summary.h"
+#include "var_table.h"
 
 class Configuration;
+class Precondition;
 
 /**
  * @brief A rich basic block is a wrapper around GCC's basic blocks to store
  * additional state
  */
 class RichBasicBlock {
+public:
+	/**
+	 * @brief The information about an edge leading to a successor,
+	 * gathered once and for all
+	 */
+	struct Successor {
+		/**
+		 * @brief The edge in the CFG, only used as an identifier
+		 */
+		edge e;
+		/**
+		 * @brief The index of the edge among the predecessors of its
+		 * destination
+		 */
+		unsigned int destIdx;
+		/**
+		 * @brief The probability of the edge, as estimated by GCC
+		 */
+		int probability;
+		/**
+		 * @brief The frequency of the destination, as estimated by
+		 * GCC
+		 */
+		int frequency;
+		/**
+		 * @brief The guard of the edge, whose term is NULL_TERM if
+		 * it cannot be interpreted
+		 */
+		InternedConstraint guard;
+		/**
+		 * @brief Whether the guard compares its operand to a
+		 * constant outside its type in a way that never holds, in
+		 * which case no path goes through the edge
+		 */
+		bool refuted;
+	};
+
 protected:
 	/**
 	 * @brief The underlying GCC basic block
 	 */
 	basic_block _bb;
+	/**
+	 * @brief The index of the underlying basic block
+	 */
+	int _index = -1;
 	/**
 	 * @brief The successors of the basic block in the CFG
+	 *
+	 * Each successor is associated with the edge leading to it and the
+	 * guard of this edge, interned once and for all.
 	 */
-	std::map<basic_block,std::tuple<edge,Constraint>> _succs;
+	ArenaMap<basic_block,Successor> _succs;
+	/**
+	 * @brief The indices of the successors, in the order of the edges
+	 */
+	std::vector<int> _succIndices;
 	/**
 	 * @brief Whether the basic block contains a flow instruction
 	 */
@@ -43,6 +98,11 @@ protected:
 	 * @brief Whether the basic block contains a LSM hook
 	 */
 	bool _hasLSM;
+	/**
+	 * @brief The effect of the statements of the basic block, compiled
+	 * once and applied to every path going through the block
+	 */
+	BlockSummary _summary;
 	/**
 	 * @brief Explore the basic block to see if it contains a flow
 	 * instruction or a LSM hook
@@ -63,14 +123,31 @@ protected:
 	 * for subclasses
 	 */
 	RichBasicBlock() = default;
+	/**
+	 * @brief Builds a rich basic block connected to one GCC basic block
+	 * @param bb the underlying basic block
+	 * @param withPhis whether the Phi nodes of \a bb must be interpreted
+	 * @param arena the arena of the function, from which the successors
+	 * are allocated
+	 */
+	RichBasicBlock(basic_block bb, bool withPhis, Arena& arena);
+	/**
+	 * @brief Builds a rich basic block standing for a chain of others,
+	 * entered like the first one and left like the last one
+	 * @param entry the first rich basic block of the chain
+	 * @param exit the last rich basic block of the chain
+	 */
+	RichBasicBlock(const RichBasicBlock& entry, const RichBasicBlock& exit);
 
 public:
 	/**
 	 * @brief Builds a regular rich basic block connected to one GCC basic
 	 * block
 	 * @param bb the underlying basic block
+	 * @param arena the arena of the function, from which the successors
+	 * are allocated
 	 */
-	explicit RichBasicBlock(basic_block bb);
+	RichBasicBlock(basic_block bb, Arena& arena);
 	/**
 	 * @brief Virtual destructor for subclasses
 	 */
@@ -90,23 +167,59 @@ public:
 	 * @return the underlying GCC basic block
 	 */
 	const basic_block& getRawBB() const { return _bb; }
+	/**
+	 * @brief Gets the index of the underlying basic block
+	 *
+	 * Unlike getRawBB()->index, this remains valid after GCC has
+	 * released the function.
+	 * @return the index of the basic block
+	 */
+	int index() const { return _index; }
+	/**
+	 * @brief Gets the compiled effect of the basic block
+	 * @return the summary of the statements of the basic block
+	 */
+	const BlockSummary& getSummary() const { return _summary; }
+	/**
+	 * @brief Estimates how much the basic block constrains a path
+	 * @return the number of constraints generated by the statements
+	 * of the basic block
+	 */
+	virtual unsigned int constraintCount() const { return _summary.constraintCount(); }
+	/**
+	 * @brief Gets the correlated edges taken inside the basic block
+	 * whenever a path goes through it
+	 * @return the identifiers of the correlated edges, in order
+	 * @see CorrelatedBranches
+	 */
+	virtual const std::vector<unsigned int>& innerGuards() const {
+		static const std::vector<unsigned int> none;
+		return none;
+	}
 	/**
 	 * @brief Update the configuration passed as a parameter with all the
 	 * constraints bringed along by this basic block
 	 * @param k the configuration to update
 	 */
 	virtual void applyAllConstraints(Configuration& k);
+	/**
+	 * @brief Extends backward the precondition of a path suffix
+	 * starting right after this basic block
+	 * @param pre the precondition to update
+	 * @param edgeTaken the index of the edge taken to reach this basic
+	 * block
+	 */
+	virtual void applyBackward(Precondition& pre, unsigned int edgeTaken) const;
 
 	/**
 	 * @brief Gets the edge and the constraint associated to it given a
 	 * basic block successor of the current basic block
 	 * @param succ another basic block. An edge must exist from the current
 	 * basic block to that one.
-	 * @return a pair (edge,constraint) where edge is the edge in the CFG
-	 * connecting the GCC basic blocks and constraint represents the
-	 * constraint born by this edge
+	 * @return the information about the edge in the CFG connecting the
+	 * GCC basic blocks, including its guard
 	 */
-	std::tuple<const edge,const Constraint&> getConstraintForSucc(const RichBasicBlock& succ) const;
+	const Successor& getConstraintForSucc(const RichBasicBlock& succ) const;
 
 /**
  * @brief Outputs a rich basic block to an output stream
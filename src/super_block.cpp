@@ -0,0 +1,64 @@
+/**
+ * @file super_block.cpp
+ * @brief Implementation of the SuperBlock class
+ * @version 0.1
+ */
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <yices.h>
+
+#include "super_block.h"
+#include "configuration.h"
+#include "precondition.h"
+
+SuperBlock::SuperBlock(const std::vector<RichBasicBlock*>& chain,
+		       const CorrelatedBranches& correlated) :
+	RichBasicBlock(*chain.front(), *chain.back()),
+	_chain(chain)
+{
+	assert(_chain.size() > 1);
+	for (auto it = _chain.cbegin() ; it + 1 != _chain.cend() ; ++it) {
+		int id = correlated.idOf((*it)->getConstraintForSucc(**(it + 1)).e);
+		if (id >= 0)
+			_innerGuards.push_back(id);
+	}
+}
+
+void SuperBlock::applyAllConstraints(Configuration& k)
+{
+	for (auto it = _chain.cbegin() ; it + 1 != _chain.cend() ; ++it) {
+		(*it)->applyAllConstraints(k);
+		const Successor& s = (*it)->getConstraintForSucc(**(it + 1));
+		k.setPredecessorInfo(*it, s.destIdx);
+		if (s.guard.term != NULL_TERM)
+			k.addConstraint(s.guard);
+	}
+	_chain.back()->applyAllConstraints(k);
+	for (unsigned int id : _innerGuards)
+		k.addTakenGuard(id);
+}
+
+unsigned int SuperBlock::constraintCount() const
+{
+	unsigned int n = 0;
+	for (const RichBasicBlock* rbb : _chain)
+		n += rbb->constraintCount();
+	return n;
+}
+
+void SuperBlock::applyBackward(Precondition& pre, unsigned int edgeTaken) const
+{
+	for (auto it = _chain.crbegin() ; it + 1 != _chain.crend() ; ++it) {
+		const Successor& s = (*(it + 1))->getConstraintForSucc(**it);
+		(*it)->applyBackward(pre, s.destIdx);
+		pre.add(s.guard);
+	}
+	_chain.front()->applyBackward(pre, edgeTaken);
+}
+
+void SuperBlock::print(std::ostream& o) const
+{
+	o << *_chain.back();
+}
@@ -0,0 +1,66 @@
+/**
+ * @file super_block.h
+ * @brief Definition of the SuperBlock class
+ * @version 0.1
+ */
+#ifndef SUPER_BLOCK_H
+#define SUPER_BLOCK_H
+
+#include <iostream>
+#include <vector>
+
+#include "rich_basic_block.h"
+#include "correlated_branches.h"
+
+class Configuration;
+class Precondition;
+
+/**
+ * @brief A maximal straight-line chain of rich basic blocks of a subgraph,
+ * walked as a single node
+ *
+ * Every block of the chain but the last has the next one as its only
+ * successor in the subgraph, and every block but the first has the previous
+ * one as its only predecessor, so the walk has no choice to make inside the
+ * chain. The superblock is entered like its first block and left like its
+ * last one. Applying it records its blocks but the last one in the path of
+ * the configuration and conjoins the guards of the edges between them
+ * without checking them: the check of the edge leaving the superblock
+ * covers them. The correlated edges of the chain are recorded as taken too.
+ *
+ * In a path, the superblock stands for its last block, after the others.
+ */
+class SuperBlock : public RichBasicBlock
+{
+private:
+	/**
+	 * @brief The blocks of the chain, in order
+	 */
+	std::vector<RichBasicBlock*> _chain;
+	/**
+	 * @brief The identifiers of the correlated edges of the chain, in
+	 * order
+	 */
+	std::vector<unsigned int> _innerGuards;
+
+public:
+	/**
+	 * @brief Builds the superblock of a chain
+	 * @param chain the blocks of the chain, at least two
+	 * @param correlated the correlated edges of the function
+	 */
+	SuperBlock(const std::vector<RichBasicBlock*>& chain,
+		   const CorrelatedBranches& correlated);
+	virtual void applyAllConstraints(Configuration& k) override;
+	virtual void applyBackward(Precondition& pre, unsigned int edgeTaken) const override;
+	/**
+	 * @brief Gets the blocks of the chain
+	 * @return the blocks of the chain, in order
+	 */
+	const std::vector<RichBasicBlock*>& chain() const { return _chain; }
+	virtual unsigned int constraintCount() const override;
+	virtual const std::vector<unsigned int>& innerGuards() const override { return _innerGuards; }
+	virtual void print(std::ostream& o) const override;
+};
+
+#endif /* SUPER_BLOCK_H */
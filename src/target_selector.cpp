@@ -0,0 +1,107 @@
+/**
+ * @file target_selector.cpp
+ * @brief Implementation of the TargetSelector class
+ * @version 0.1
+ */
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+
+#include <fnmatch.h>
+#include <yaml-cpp/yaml.h>
+
+#include "target_selector.h"
+#include "analysis_settings.h"
+#include "debug.h"
+
+namespace {
+	/**
+	 * @brief Reads the settings defined in a YAML map
+	 * @param node the YAML map
+	 * @param settings the settings to start from, the keys absent from
+	 * \a node keep the value they have here
+	 * @return the updated settings
+	 */
+	AnalysisSettings readSettings(const YAML::Node& node, AnalysisSettings settings)
+	{
+		if (node["budget"])
+			settings.budget = node["budget"].as<unsigned long>();
+		if (node["witnesses"])
+			settings.witnesses = node["witnesses"].as<unsigned int>();
+		if (node["frontier"])
+			settings.frontier = node["frontier"].as<unsigned long>();
+		if (node["samples"])
+			settings.samples = node["samples"].as<unsigned long>();
+		if (node["seed"])
+			settings.seed = node["seed"].as<unsigned long>();
+		if (node["mode"]) {
+			std::string mode = node["mode"].as<std::string>();
+			if (!AnalysisSettings::parseSearchMode(mode, settings.mode))
+				throw std::runtime_error("Unknown search mode: " + mode);
+		}
+		if (node["order"]) {
+			std::string order = node["order"].as<std::string>();
+			if (!AnalysisSettings::parseSuccessorOrder(order, settings.order))
+				throw std::runtime_error("Unknown successor order: " + order);
+		}
+		if (node["direction"]) {
+			std::string direction = node["direction"].as<std::string>();
+			if (!AnalysisSettings::parseDirection(direction, settings.direction))
+				throw std::runtime_error("Unknown walk direction: " + direction);
+		}
+		if (node["output"]) {
+			std::string output = node["output"].as<std::string>();
+			if (!AnalysisSettings::parsePathOutput(output, settings.output))
+				throw std::runtime_error("Unknown path output: " + output);
+		}
+		return settings;
+	}
+}
+
+void TargetSelector::addFunction(const std::string& pattern, const AnalysisSettings& settings)
+{
+	if (pattern.find_first_of("*?[") == pattern.npos)
+		_exact[pattern] = settings;
+	else
+		_globs.emplace_back(pattern, settings);
+}
+
+void TargetSelector::loadFile(const std::string& path)
+{
+	try {
+		YAML::Node config = YAML::LoadFile(path);
+		if (config["defaults"])
+			_defaults = readSettings(config["defaults"], _defaults);
+
+		for (const YAML::Node& entry : config["functions"]) {
+			if (entry.IsScalar())
+				addFunction(entry.as<std::string>(), _defaults);
+			else if (entry["name"])
+				addFunction(entry["name"].as<std::string>(),
+					    readSettings(entry, _defaults));
+			else
+				throw std::runtime_error("Function entry without a name");
+		}
+	} catch (YAML::Exception& e) {
+		throw std::runtime_error(path + ": " + e.what());
+	}
+	debug() << "Configuration loaded: " << _exact.size() << " functions and "
+		<< _globs.size() << " patterns" << std::endl;
+}
+
+const AnalysisSettings* TargetSelector::match(const char* name) const
+{
+	if (empty())
+		return &_defaults;
+
+	auto it = _exact.find(name);
+	if (it != _exact.end())
+		return &it->second;
+
+	for (const auto& glob : _globs)
+		if (fnmatch(glob.first.c_str(), name, 0) == 0)
+			return &glob.second;
+
+	return nullptr;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file target_selector.h
+ * @brief Definition of the TargetSelector class
+ * @version 0.1
+ */
+#ifndef TARGET_SELECTOR_H
+#define TARGET_SELECTOR_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+#include "analysis_settings.h"
+
+/**
+ * @brief Decides which functions must be analyzed, and with which settings
+ *
+ * The functions are selected either by their exact name or by a glob
+ * pattern. The exact names are stored in a hash table, the patterns are only
+ * tried, in the order they were given, for the functions whose name is not
+ * listed.
+ */
+class TargetSelector
+{
+	private:
+		/**
+		 * @brief The settings of the functions selected by name
+		 */
+		std::unordered_map<std::string,AnalysisSettings> _exact;
+		/**
+		 * @brief The glob patterns and the settings of the functions
+		 * they select
+		 */
+		std::vector<std::pair<std::string,AnalysisSettings>> _globs;
+		/**
+		 * @brief The settings of functions selected by no entry, when
+		 * no function is listed at all
+		 */
+		AnalysisSettings _defaults;
+
+	public:
+		/**
+		 * @brief Gets the default settings, applied to functions
+		 * listed without explicit settings
+		 * @return the default settings
+		 */
+		AnalysisSettings& defaults() { return _defaults; }
+		/**
+		 * @brief Selects a function or a group of functions
+		 * @param pattern the name of a function or a glob pattern
+		 * @param settings the settings to use for the functions
+		 * matched by \a pattern
+		 */
+		void addFunction(const std::string& pattern, const AnalysisSettings& settings);
+		/**
+		 * @brief Reads the list of functions to analyze from a YAML
+		 * file
+		 *
+		 * The file is expected to look like this:
+		 * <pre>
+		 * defaults:
+		 *   budget: 100000
+		 *   mode: exhaustive
+		 * functions:
+		 *   - do_sys_open
+		 *   - name: "vfs_*"
+		 *     budget: 5000
+		 *     mode: first-witness
+		 *     witnesses: 10
+		 * </pre>
+		 * The <code>defaults</code> section is optional and updates
+		 * the default settings.
+		 * @param path the path of the file
+		 * @throw std::runtime_error if the file cannot be read or is
+		 * ill-formed
+		 */
+		void loadFile(const std::string& path);
+		/**
+		 * @brief Tells whether no function is selected explicitly, in
+		 * which case all functions are analyzed with the default
+		 * settings
+		 * @return true if, and only if, no function was added
+		 */
+		bool empty() const { return _exact.empty() && _globs.empty(); }
+		/**
+		 * @brief Finds the settings for a function
+		 * @param name the name of the function
+		 * @return the settings to use to analyze \a name or nullptr if
+		 * the function must not be analyzed
+		 */
+		const AnalysisSettings* match(const char* name) const;
+};
+
+#endif /* ifndef TARGET_SELECTOR_H */
@@ -0,0 +1,36 @@
+/**
+ * @file var_table.cpp
+ * @brief Implementation of the VarTable class
+ * @version 0.1
+ */
+#include <cstdlib>
+#include <gcc-plugin.h>
+#include <tree.h>
+#include <gimple.h>
+#include <tree-flow.h>
+
+#include "var_table.h"
+#include "may_alias_sets.h"
+
+constexpr VarTable::VarId VarTable::NONE;
+
+VarTable::VarId VarTable::intern(tree t, const MayAliasSets* sets)
+{
+	if (!t || !is_gimple_variable(t))
+		return NONE;
+
+	auto it = _ids.find(t);
+	if (it != _ids.end())
+		return it->second;
+
+	VarId id = _entries.size();
+	_entries.push_back(Entry{t, bool(is_gimple_reg(t)), sets ? sets->indexOf(t) : -1});
+	_ids.emplace(t, id);
+	return id;
+}
+
+void VarTable::clear()
+{
+	_entries.resize(1);
+	_ids.clear();
+}
@@ -0,0 +1,147 @@
+/**
+ * @file var_table.h
+ * @brief Definition of the VarTable class
+ * @version 0.1
+ */
+#ifndef VAR_TABLE_H
+#define VAR_TABLE_H
+
+#include <gcc-plugin.h>
+#include <tree.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <yices.h>
+
+class MayAliasSets;
+
+/**
+ * @brief Interns the variables of the function under analysis as dense
+ * 32-bit identifiers, along with the properties the configurations need
+ *
+ * The properties are computed once, when a variable is interned, so that the
+ * configurations never have to query GCC about their variables.
+ */
+class VarTable
+{
+	public:
+		/**
+		 * @brief The identifier of a variable
+		 */
+		typedef uint32_t VarId;
+		/**
+		 * @brief The identifier of anything which is not a variable
+		 * (constants, addresses, or no tree at all)
+		 */
+		static constexpr VarId NONE = 0;
+
+	private:
+		/**
+		 * @brief The properties of an interned variable
+		 */
+		struct Entry {
+			/**
+			 * @brief The variable
+			 */
+			tree var;
+			/**
+			 * @brief Whether the variable is a register, i.e.
+			 * cannot be modified through memory
+			 */
+			bool reg;
+			/**
+			 * @brief The index of the variable in the may-alias
+			 * sets, or -1 if it is not an indexed local variable
+			 */
+			int local;
+		};
+
+		/**
+		 * @brief The interned variables, indexed by identifier (the
+		 * first entry stands for NONE)
+		 */
+		std::vector<Entry> _entries{Entry{NULL_TREE, false, -1}};
+		/**
+		 * @brief The identifier of each interned variable
+		 */
+		std::unordered_map<tree,VarId> _ids;
+
+	public:
+		/**
+		 * @brief Gets the identifier of a tree, interning it if
+		 * necessary
+		 * @param t a tree
+		 * @param sets the may-alias sets of the function, may be
+		 * nullptr
+		 * @return the identifier of \a t, or NONE if \a t is not a
+		 * variable
+		 */
+		VarId intern(tree t, const MayAliasSets* sets);
+		/**
+		 * @brief Gets the identifier of a tree, without interning it
+		 * @param t a tree
+		 * @return the identifier of \a t, or NONE if \a t has not
+		 * been interned
+		 */
+		VarId lookup(tree t) const {
+			auto it = _ids.find(t);
+			return it == _ids.end() ? NONE : it->second;
+		}
+		/**
+		 * @brief Gets an interned variable
+		 * @param id an identifier
+		 * @return the variable identified by \a id
+		 */
+		tree var(VarId id) const { return _entries[id].var; }
+		/**
+		 * @brief Tells whether a variable is a register
+		 * @param id an identifier
+		 * @return true if, and only if, the variable identified by
+		 * \a id is a register
+		 */
+		bool isRegister(VarId id) const { return _entries[id].reg; }
+		/**
+		 * @brief Gets the index of a variable in the may-alias sets
+		 * @param id an identifier
+		 * @return the index of the variable identified by \a id, or
+		 * -1 if it is not an indexed local variable
+		 */
+		int local(VarId id) const { return _entries[id].local; }
+		/**
+		 * @brief Forgets all the interned variables
+		 */
+		void clear();
+};
+
+/**
+ * @brief A constraint whose variables are interned and whose Yices term is
+ * built, ready to be added to a configuration without looking at any tree
+ */
+struct InternedConstraint {
+	/**
+	 * @brief The left-hand side variable
+	 */
+	VarTable::VarId lhs = VarTable::NONE;
+	/**
+	 * @brief The right-hand side variable
+	 */
+	VarTable::VarId rhs = VarTable::NONE;
+	/**
+	 * @brief The second right-hand side variable, for arithmetic
+	 * operations
+	 */
+	VarTable::VarId rhs2 = VarTable::NONE;
+	/**
+	 * @brief The Yices term representing the constraint, or NULL_TERM if
+	 * the constraint cannot be interpreted
+	 */
+	term_t term = NULL_TERM;
+	/**
+	 * @brief Whether the constraint is about a variable living in memory
+	 */
+	bool mem = false;
+};
+
+#endif /* ifndef VAR_TABLE_H */